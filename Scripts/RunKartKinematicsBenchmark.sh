@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+# Builds and runs the GoKartKinematicsBenchmark program, which times the kart kinematics linked against nothing but Core
+# and the GoKartKinematics module, and prints its results. Exits non-zero if the scalar and SIMD paths disagree, so it
+# can run as a CI step.
+#
+# Usage: Scripts/RunKartKinematicsBenchmark.sh [-k karts] [-n moves per kart] [-s seed] [-u max substeps]
+# Set UE4_ROOT to the engine directory (the one containing Engine/) if it isn't ../UnrealEngine.
+set -euo pipefail
+
+PROJECT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+PROJECT="$PROJECT_DIR/KrazyKarts.uproject"
+ENGINE_DIR="${UE4_ROOT:-$PROJECT_DIR/../UnrealEngine}"
+
+KARTS=1024
+MOVES=1000
+SEED=0
+SUBSTEPS=1
+
+while getopts "k:n:s:u:h" Option; do
+	case "$Option" in
+		k) KARTS="$OPTARG" ;;
+		n) MOVES="$OPTARG" ;;
+		s) SEED="$OPTARG" ;;
+		u) SUBSTEPS="$OPTARG" ;;
+		*) sed -n '2,7p' "$0"; exit 1 ;;
+	esac
+done
+
+case "$(uname -s)" in
+	Linux) PLATFORM=Linux; BUILD="$ENGINE_DIR/Engine/Build/BatchFiles/Linux/Build.sh"; PROGRAM=GoKartKinematicsBenchmark ;;
+	Darwin) PLATFORM=Mac; BUILD="$ENGINE_DIR/Engine/Build/BatchFiles/Mac/Build.sh"; PROGRAM=GoKartKinematicsBenchmark ;;
+	*) PLATFORM=Win64; BUILD="$ENGINE_DIR/Engine/Build/BatchFiles/Build.bat"; PROGRAM=GoKartKinematicsBenchmark.exe ;;
+esac
+
+LOG="$PROJECT_DIR/Saved/KinematicsBenchmark.log"
+mkdir -p "$(dirname "$LOG")"
+
+"$BUILD" GoKartKinematicsBenchmark "$PLATFORM" Development -Project="$PROJECT" > "$LOG" 2>&1 || { cat "$LOG"; exit 1; }
+
+Status=0
+"$PROJECT_DIR/Binaries/$PLATFORM/$PROGRAM" -Karts="$KARTS" -Moves="$MOVES" -Seed="$SEED" -Substeps="$SUBSTEPS" \
+	>> "$LOG" 2>&1 || Status=$?
+grep "KartKinematicsBenchmark:" "$LOG" | sed 's/.*KartKinematicsBenchmark: //' | uniq
+exit $Status
@@ -0,0 +1,74 @@
+#!/usr/bin/env bash
+# Runs a dedicated server and a number of headless bot clients on this machine, each driving its kart with the
+# scripted input in UGoKartLoadTestSubsystem, then prints the per-process reports written to Saved/LoadTest.
+#
+# Usage: Scripts/RunKartLoadTest.sh [-c clients] [-d seconds] [-l lag ms] [-v lag variance ms] [-p loss %] [-m map]
+# Set UE4_EDITOR to the UE4Editor binary (UE4Editor-Cmd.exe on Windows) if it isn't on the PATH.
+# The default map comes from UE4's Vehicle C++ template, whose content isn't checked in here - copy its Content/VehicleCPP
+# folder into this project first, or pass -m with a map of your own.
+set -euo pipefail
+
+PROJECT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+PROJECT="$PROJECT_DIR/KrazyKarts.uproject"
+EDITOR="${UE4_EDITOR:-UE4Editor}"
+
+CLIENTS=8
+DURATION=120
+LAG=0
+LAG_VARIANCE=0
+LOSS=0
+MAP=/Game/VehicleCPP/Maps/VehicleExampleMap
+# Give the clients time to start and join before the server starts counting down
+SERVER_GRACE=30
+
+while getopts "c:d:l:v:p:m:h" Option; do
+	case "$Option" in
+		c) CLIENTS="$OPTARG" ;;
+		d) DURATION="$OPTARG" ;;
+		l) LAG="$OPTARG" ;;
+		v) LAG_VARIANCE="$OPTARG" ;;
+		p) LOSS="$OPTARG" ;;
+		m) MAP="$OPTARG" ;;
+		*) sed -n '2,8p' "$0"; exit 1 ;;
+	esac
+done
+
+# A missing map doesn't stop the server starting, it just loads the entry map and every client times out
+if [[ "$MAP" == /Game/* ]]; then
+	MAP_FILE="$PROJECT_DIR/Content/${MAP#/Game/}.umap"
+	if [ ! -f "$MAP_FILE" ]; then
+		echo "Map $MAP not found at $MAP_FILE" >&2
+		echo "Copy Content/VehicleCPP in from a new Vehicle C++ template project, or pass -m with another map." >&2
+		exit 1
+	fi
+fi
+
+REPORT_DIR="$PROJECT_DIR/Saved/LoadTest"
+mkdir -p "$REPORT_DIR"
+rm -f "$REPORT_DIR"/*.csv
+
+# Packet emulation is only compiled into non-shipping builds
+NET_EMULATION="-PktLag=$LAG -PktLagVariance=$LAG_VARIANCE -PktLoss=$LOSS"
+PIDS=()
+
+echo "Starting dedicated server on $MAP for $((DURATION + SERVER_GRACE))s"
+"$EDITOR" "$PROJECT" "$MAP" -server -log -unattended -KartLoadTest \
+	-KartLoadTestDuration=$((DURATION + SERVER_GRACE)) $NET_EMULATION > "$REPORT_DIR/Server.log" 2>&1 &
+PIDS+=($!)
+sleep 10
+
+for ((Client = 0; Client < CLIENTS; ++Client)); do
+	echo "Starting bot client $Client"
+	"$EDITOR" "$PROJECT" 127.0.0.1 -game -nullrhi -nosound -unattended -KartLoadTest \
+		-KartLoadTestDuration="$DURATION" -KartBotSeed="$Client" $NET_EMULATION > "$REPORT_DIR/Client$Client.log" 2>&1 &
+	PIDS+=($!)
+done
+
+trap 'kill "${PIDS[@]}" 2>/dev/null' INT TERM
+wait "${PIDS[@]}" || true
+
+for Report in "$REPORT_DIR"/Server-*.csv "$REPORT_DIR"/Client-*.csv; do
+	[ -f "$Report" ] || continue
+	echo "== $(basename "$Report")"
+	column -s, -t < "$Report" 2>/dev/null || cat "$Report"
+done
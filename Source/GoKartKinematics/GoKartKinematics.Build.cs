@@ -0,0 +1,13 @@
+using UnrealBuildTool;
+
+// The kart kinematics, kept free of the engine so they can be built into programs with no world (see
+// Source/Programs/GoKartKinematicsBenchmark). Don't add dependencies beyond Core.
+public class GoKartKinematics : ModuleRules
+{
+	public GoKartKinematics(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.Add("Core");
+	}
+}
@@ -0,0 +1,75 @@
+#include "GoKartKinematics.h"
+
+FGoKartKinematicsTuning FGoKartKinematicsTuning::Make(float Mass, float MaxDrivingForce, float DragCoefficient, float RollingResistanceCoefficient, float MinTurningRadius, float GravityAcceleration)
+{
+	FGoKartKinematicsTuning Tuning;
+	Tuning.MaxDrivingForce = MaxDrivingForce;
+	Tuning.InverseMass = 1.f / Mass;
+	Tuning.DragCoefficient = DragCoefficient;
+	// F = m * g
+	float NormalForce = Mass * GravityAcceleration;
+	Tuning.RollingResistanceForce = RollingResistanceCoefficient * NormalForce;
+	Tuning.InverseTurningRadius = 1.f / MinTurningRadius;
+	return Tuning;
+}
+
+int32 FGoKartKinematics::GetSubstepCount(const FGoKartKinematicsTuning& Tuning, const FVector& Velocity, const FGoKartKinematicsInput& Input)
+{
+	if (Tuning.MaxSubsteps <= 1) return 1;
+	// One lane of the SIMD batch's calculation, so a move lands on the same side of a substep boundary either way
+	VectorRegister Counts = GetSubstepCounts(VectorSetFloat1(Velocity.X), VectorSetFloat1(Velocity.Y), VectorSetFloat1(Velocity.Z),
+		VectorSetFloat1(Tuning.MaxDrivingForce * Input.Throttle), VectorSetFloat1(Tuning.DragCoefficient), VectorSetFloat1(Tuning.InverseMass),
+		VectorSetFloat1(Input.DeltaTime), VectorSetFloat1(static_cast<float>(Tuning.MaxSubsteps)));
+	return static_cast<int32>(VectorGetComponent(Counts, 0));
+}
+
+FGoKartKinematicsStep FGoKartKinematics::IntegrateForces(const FGoKartKinematicsTuning& Tuning, const FVector& Velocity, const FGoKartKinematicsInput& Input)
+{
+	int32 Substeps = GetSubstepCount(Tuning, Velocity, Input);
+	float SubstepTime = Input.DeltaTime / Substeps;
+	// Create our "driving force" by taking our input * driving force * forward, and find the Dv = F / M * Dt it gives us
+	FVector DriveDeltaVelocity = Input.Forward * Tuning.MaxDrivingForce * Input.Throttle * Tuning.InverseMass * SubstepTime;
+	FGoKartKinematicsStep Result;
+	Result.Velocity = Velocity;
+	for (int32 Substep = 0; Substep < Substeps; ++Substep)
+	{
+		// Air Resistance = -Speed^2 * DragCoefficient, RollingResistance = -RRCoefficient * NormalForce, both against our
+		// direction of travel - as a fraction of our Velocity they take away this step
+		float SpeedSquared = Result.Velocity.SizeSquared();
+		float InverseSpeed = SpeedSquared > SMALL_NUMBER ? FMath::InvSqrt(SpeedSquared) : 0;
+		float Resistance = (SpeedSquared * Tuning.DragCoefficient + Tuning.RollingResistanceForce) * InverseSpeed * Tuning.InverseMass * SubstepTime;
+		if (Tuning.MaxSubsteps > 1)
+		{
+			Resistance = FMath::Min(Resistance, 1.f);
+		}
+		Result.Velocity += DriveDeltaVelocity - Result.Velocity * Resistance;
+		// Move at our new Velocity for the step
+		Result.Translation += Result.Velocity * SubstepTime;
+	}
+	// Our Velocity is in m/s, Unreal units are cm
+	Result.Translation *= 100;
+	return Result;
+}
+
+float FGoKartKinematics::GetRotationAngle(const FGoKartKinematicsTuning& Tuning, const FVector& Translation, const FGoKartKinematicsInput& Input)
+{
+	// dX - change in location along our turning circle over the move (m)
+	float DeltaLocation = FVector::DotProduct(Input.Forward, Translation) * 0.01f;
+	// dTheta = dX / R, scaled by our steering input
+	return DeltaLocation * Tuning.InverseTurningRadius * Input.SteeringThrow;
+}
+
+FVector FGoKartKinematics::RotateVelocity(const FVector& Velocity, const FVector& Up, float RotationAngle)
+{
+	if (RotationAngle == 0) return Velocity;
+	return FQuat(Up, RotationAngle).RotateVector(Velocity);
+}
+
+FGoKartKinematicsStep FGoKartKinematics::Step(const FGoKartKinematicsTuning& Tuning, const FVector& Velocity, const FGoKartKinematicsInput& Input)
+{
+	// Same order as the Movement Component: accelerate and move, then turn
+	FGoKartKinematicsStep Result = IntegrateForces(Tuning, Velocity, Input);
+	Result.RotationAngle = GetRotationAngle(Tuning, Result.Translation, Input);
+	Result.Velocity = RotateVelocity(Result.Velocity, Input.Up, Result.RotationAngle);
+	return Result;
+}
@@ -0,0 +1,263 @@
+#include "GoKartKinematicsBatch.h"
+
+int32 FGoKartKinematicsBatch::AddKart() 
+{
+	if (FreeSlots.Num() == 0) 
+	{
+		Grow();
+	}
+	int32 Slot = FreeSlots.Pop(false);
+	SetVelocity(Slot, FVector::ZeroVector);
+	ClearMove(Slot);
+	return Slot;
+}
+
+void FGoKartKinematicsBatch::RemoveKart(int32 Slot) 
+{
+	// Zero the tuning so the free slot stays inert in the SIMD loops
+	SetTuning(Slot, FGoKartKinematicsTuning());
+	SetVelocity(Slot, FVector::ZeroVector);
+	ClearMove(Slot);
+	FreeSlots.Add(Slot);
+}
+
+void FGoKartKinematicsBatch::Grow() 
+{
+	int32 NewCapacity = FMath::Max(Capacity * 2, 4);
+	for (FAlignedFloatArray* Array : { &VelocityX, &VelocityY, &VelocityZ, &TranslationX, &TranslationY, &TranslationZ, &RotationAngle, &ForwardX, &ForwardY, &ForwardZ,
+		&UpX, &UpY, &UpZ, &Throttle, &SteeringThrow, &DeltaTime, &MaxDrivingForce, &InverseMass, &DragCoefficient, &RollingResistanceForce,
+		&InverseTurningRadius, &MaxSubsteps }) 
+	{
+		Array->SetNumZeroed(NewCapacity);
+	}
+	// Hand out the lowest slots first so active karts stay packed at the front
+	for (int32 Slot = NewCapacity - 1; Slot >= Capacity; --Slot) 
+	{
+		FreeSlots.Add(Slot);
+	}
+	Capacity = NewCapacity;
+}
+
+SIZE_T FGoKartKinematicsBatch::GetAllocatedSize() const
+{
+	SIZE_T Size = FreeSlots.GetAllocatedSize();
+	for (const FAlignedFloatArray* Array : { &VelocityX, &VelocityY, &VelocityZ, &TranslationX, &TranslationY, &TranslationZ, &RotationAngle, &ForwardX, &ForwardY, &ForwardZ,
+		&UpX, &UpY, &UpZ, &Throttle, &SteeringThrow, &DeltaTime, &MaxDrivingForce, &InverseMass, &DragCoefficient, &RollingResistanceForce,
+		&InverseTurningRadius, &MaxSubsteps }) 
+	{
+		Size += Array->GetAllocatedSize();
+	}
+	return Size;
+}
+
+void FGoKartKinematicsBatch::SetTuning(int32 Slot, const FGoKartKinematicsTuning& Tuning) 
+{
+	MaxDrivingForce[Slot] = Tuning.MaxDrivingForce;
+	InverseMass[Slot] = Tuning.InverseMass;
+	DragCoefficient[Slot] = Tuning.DragCoefficient;
+	RollingResistanceForce[Slot] = Tuning.RollingResistanceForce;
+	InverseTurningRadius[Slot] = Tuning.InverseTurningRadius;
+	MaxSubsteps[Slot] = Tuning.MaxSubsteps;
+}
+
+FGoKartKinematicsTuning FGoKartKinematicsBatch::GetTuning(int32 Slot) const
+{
+	FGoKartKinematicsTuning Tuning;
+	Tuning.MaxDrivingForce = MaxDrivingForce[Slot];
+	Tuning.InverseMass = InverseMass[Slot];
+	Tuning.DragCoefficient = DragCoefficient[Slot];
+	Tuning.RollingResistanceForce = RollingResistanceForce[Slot];
+	Tuning.InverseTurningRadius = InverseTurningRadius[Slot];
+	Tuning.MaxSubsteps = static_cast<int32>(MaxSubsteps[Slot]);
+	return Tuning;
+}
+
+FVector FGoKartKinematicsBatch::GetVelocity(int32 Slot) const
+{
+	return FVector(VelocityX[Slot], VelocityY[Slot], VelocityZ[Slot]);
+}
+
+void FGoKartKinematicsBatch::SetVelocity(int32 Slot, const FVector& Velocity) 
+{
+	VelocityX[Slot] = Velocity.X;
+	VelocityY[Slot] = Velocity.Y;
+	VelocityZ[Slot] = Velocity.Z;
+}
+
+FVector FGoKartKinematicsBatch::GetTranslation(int32 Slot) const
+{
+	return FVector(TranslationX[Slot], TranslationY[Slot], TranslationZ[Slot]);
+}
+
+void FGoKartKinematicsBatch::SetTranslation(int32 Slot, const FVector& Translation) 
+{
+	TranslationX[Slot] = Translation.X;
+	TranslationY[Slot] = Translation.Y;
+	TranslationZ[Slot] = Translation.Z;
+}
+
+float FGoKartKinematicsBatch::GetRotationAngle(int32 Slot) const
+{
+	return RotationAngle[Slot];
+}
+
+void FGoKartKinematicsBatch::SetMove(int32 Slot, const FVector& Forward, const FVector& Up, float MoveThrottle, float MoveSteeringThrow, float MoveDeltaTime) 
+{
+	ForwardX[Slot] = Forward.X;
+	ForwardY[Slot] = Forward.Y;
+	ForwardZ[Slot] = Forward.Z;
+	UpX[Slot] = Up.X;
+	UpY[Slot] = Up.Y;
+	UpZ[Slot] = Up.Z;
+	Throttle[Slot] = MoveThrottle;
+	SteeringThrow[Slot] = MoveSteeringThrow;
+	DeltaTime[Slot] = MoveDeltaTime;
+}
+
+FGoKartKinematicsInput FGoKartKinematicsBatch::GetMove(int32 Slot) const
+{
+	FGoKartKinematicsInput Move;
+	Move.Forward = FVector(ForwardX[Slot], ForwardY[Slot], ForwardZ[Slot]);
+	Move.Up = FVector(UpX[Slot], UpY[Slot], UpZ[Slot]);
+	Move.Throttle = Throttle[Slot];
+	Move.SteeringThrow = SteeringThrow[Slot];
+	Move.DeltaTime = DeltaTime[Slot];
+	return Move;
+}
+
+void FGoKartKinematicsBatch::ClearMove(int32 Slot) 
+{
+	SetMove(Slot, FVector::ZeroVector, FVector::ZeroVector, 0, 0, 0);
+	SetTranslation(Slot, FVector::ZeroVector);
+	RotationAngle[Slot] = 0;
+}
+
+void FGoKartKinematicsBatch::ClearMoves() 
+{
+	for (int32 Slot = 0; Slot < Capacity; ++Slot) 
+	{
+		ClearMove(Slot);
+	}
+}
+
+void FGoKartKinematicsBatch::IntegrateForces() 
+{
+	IntegrateForcesInRange(0, Capacity);
+}
+
+void FGoKartKinematicsBatch::IntegrateRotation() 
+{
+	IntegrateRotationInRange(0, Capacity);
+}
+
+void FGoKartKinematicsBatch::IntegrateForcesInRange(int32 BeginSlot, int32 EndSlot) 
+{
+	check(BeginSlot % 4 == 0 && EndSlot <= Capacity);
+	const VectorRegister SmallNumber = VectorSetFloat1(SMALL_NUMBER);
+	const VectorRegister One = VectorOne();
+	const VectorRegister MetersToCentimeters = VectorSetFloat1(100);
+	for (int32 Slot = BeginSlot; Slot < EndSlot; Slot += 4) 
+	{
+		VectorRegister VX = VectorLoadAligned(&VelocityX[Slot]);
+		VectorRegister VY = VectorLoadAligned(&VelocityY[Slot]);
+		VectorRegister VZ = VectorLoadAligned(&VelocityZ[Slot]);
+		VectorRegister LaneMaxSubsteps = VectorLoadAligned(&MaxSubsteps[Slot]);
+		VectorRegister LaneDrag = VectorLoadAligned(&DragCoefficient[Slot]);
+		VectorRegister LaneInverseMass = VectorLoadAligned(&InverseMass[Slot]);
+		VectorRegister LaneDrivingForce = VectorMultiply(VectorLoadAligned(&MaxDrivingForce[Slot]), VectorLoadAligned(&Throttle[Slot]));
+		VectorRegister LaneDeltaTime = VectorLoadAligned(&DeltaTime[Slot]);
+		// Every lane is split into the same substeps as the scalar path, by the same calculation. Lanes needing fewer sit
+		// out the later substeps with a step time of 0.
+		VectorRegister SubstepCount = One;
+		int32 Substeps = 1;
+		if (VectorMaskBits(VectorCompareGT(LaneMaxSubsteps, One)) != 0) 
+		{
+			SubstepCount = FGoKartKinematics::GetSubstepCounts(VX, VY, VZ, LaneDrivingForce, LaneDrag, LaneInverseMass, LaneDeltaTime, LaneMaxSubsteps);
+			MS_ALIGN(16) float LaneSubsteps[4] GCC_ALIGN(16);
+			VectorStoreAligned(SubstepCount, LaneSubsteps);
+			Substeps = static_cast<int32>(FMath::Max(FMath::Max(LaneSubsteps[0], LaneSubsteps[1]), FMath::Max(LaneSubsteps[2], LaneSubsteps[3])));
+		}
+		VectorRegister SubstepTime = VectorDivide(LaneDeltaTime, SubstepCount);
+		// Substepped karts can be stopped by resistance but never pushed backwards
+		VectorRegister ResistanceLimit = VectorSelect(VectorCompareGT(LaneMaxSubsteps, One), One, VectorSetFloat1(BIG_NUMBER));
+		// Driving force = input * driving force (along our forward vector), Dv = F / M * Dt
+		VectorRegister DriveAcceleration = VectorMultiply(LaneDrivingForce, LaneInverseMass);
+		VectorRegister TX = VectorZero();
+		VectorRegister TY = VectorZero();
+		VectorRegister TZ = VectorZero();
+		for (int32 Substep = 0; Substep < Substeps; ++Substep) 
+		{
+			VectorRegister StepTime = VectorSelect(VectorCompareGT(SubstepCount, VectorSetFloat1(Substep)), SubstepTime, VectorZero());
+			VectorRegister SizeSquared = VectorMultiplyAdd(VX, VX, VectorMultiplyAdd(VY, VY, VectorMultiply(VZ, VZ)));
+			// Same as GetSafeNormal() - a (nearly) stopped kart has no direction to resist
+			VectorRegister HasDirection = VectorCompareGT(SizeSquared, SmallNumber);
+			VectorRegister InverseSpeed = VectorSelect(HasDirection, VectorReciprocalSqrtAccurate(SizeSquared), VectorZero());
+			// Air resistance (Speed^2 * DragCoefficient) and rolling resistance both act against our direction of travel,
+			// as a fraction of our Velocity they take away this step
+			VectorRegister Resistance = VectorMultiply(VectorMultiplyAdd(SizeSquared, LaneDrag, VectorLoadAligned(&RollingResistanceForce[Slot])), InverseSpeed);
+			Resistance = VectorMin(VectorMultiply(VectorMultiply(Resistance, LaneInverseMass), StepTime), ResistanceLimit);
+			VectorRegister Drive = VectorMultiply(DriveAcceleration, StepTime);
+			VX = VectorMultiplyAdd(VectorLoadAligned(&ForwardX[Slot]), Drive, VectorSubtract(VX, VectorMultiply(VX, Resistance)));
+			VY = VectorMultiplyAdd(VectorLoadAligned(&ForwardY[Slot]), Drive, VectorSubtract(VY, VectorMultiply(VY, Resistance)));
+			VZ = VectorMultiplyAdd(VectorLoadAligned(&ForwardZ[Slot]), Drive, VectorSubtract(VZ, VectorMultiply(VZ, Resistance)));
+			// Move at our new Velocity for the step
+			TX = VectorMultiplyAdd(VX, StepTime, TX);
+			TY = VectorMultiplyAdd(VY, StepTime, TY);
+			TZ = VectorMultiplyAdd(VZ, StepTime, TZ);
+		}
+		VectorStoreAligned(VX, &VelocityX[Slot]);
+		VectorStoreAligned(VY, &VelocityY[Slot]);
+		VectorStoreAligned(VZ, &VelocityZ[Slot]);
+		VectorStoreAligned(VectorMultiply(TX, MetersToCentimeters), &TranslationX[Slot]);
+		VectorStoreAligned(VectorMultiply(TY, MetersToCentimeters), &TranslationY[Slot]);
+		VectorStoreAligned(VectorMultiply(TZ, MetersToCentimeters), &TranslationZ[Slot]);
+	}
+}
+
+void FGoKartKinematicsBatch::IntegrateRotationInRange(int32 BeginSlot, int32 EndSlot) 
+{
+	check(BeginSlot % 4 == 0 && EndSlot <= Capacity);
+	const VectorRegister One = VectorOne();
+	const VectorRegister CentimetersToMeters = VectorSetFloat1(0.01f);
+	for (int32 Slot = BeginSlot; Slot < EndSlot; Slot += 4) 
+	{
+		VectorRegister VX = VectorLoadAligned(&VelocityX[Slot]);
+		VectorRegister VY = VectorLoadAligned(&VelocityY[Slot]);
+		VectorRegister VZ = VectorLoadAligned(&VelocityZ[Slot]);
+		VectorRegister UX = VectorLoadAligned(&UpX[Slot]);
+		VectorRegister UY = VectorLoadAligned(&UpY[Slot]);
+		VectorRegister UZ = VectorLoadAligned(&UpZ[Slot]);
+		// dX = Forward . Translation (in m), dTheta = dX / R, scaled by our steering input
+		VectorRegister ForwardDistance = VectorMultiplyAdd(VectorLoadAligned(&ForwardX[Slot]), VectorLoadAligned(&TranslationX[Slot]),
+			VectorMultiplyAdd(VectorLoadAligned(&ForwardY[Slot]), VectorLoadAligned(&TranslationY[Slot]), VectorMultiply(VectorLoadAligned(&ForwardZ[Slot]), VectorLoadAligned(&TranslationZ[Slot]))));
+		VectorRegister DeltaLocation = VectorMultiply(ForwardDistance, CentimetersToMeters);
+		VectorRegister Angle = VectorMultiply(DeltaLocation, VectorMultiply(VectorLoadAligned(&InverseTurningRadius[Slot]), VectorLoadAligned(&SteeringThrow[Slot])));
+		VectorRegister Sin, Cos;
+		VectorSinCos(&Sin, &Cos, &Angle);
+		// Rodrigues' rotation of Velocity about Up: V cos + (Up x V) sin + Up (Up . V)(1 - cos)
+		VectorRegister UpDotV = VectorMultiplyAdd(UX, VX, VectorMultiplyAdd(UY, VY, VectorMultiply(UZ, VZ)));
+		VectorRegister AlongUp = VectorMultiply(UpDotV, VectorSubtract(One, Cos));
+		VectorRegister CrossX = VectorSubtract(VectorMultiply(UY, VZ), VectorMultiply(UZ, VY));
+		VectorRegister CrossY = VectorSubtract(VectorMultiply(UZ, VX), VectorMultiply(UX, VZ));
+		VectorRegister CrossZ = VectorSubtract(VectorMultiply(UX, VY), VectorMultiply(UY, VX));
+		VectorStoreAligned(VectorMultiplyAdd(UX, AlongUp, VectorMultiplyAdd(CrossX, Sin, VectorMultiply(VX, Cos))), &VelocityX[Slot]);
+		VectorStoreAligned(VectorMultiplyAdd(UY, AlongUp, VectorMultiplyAdd(CrossY, Sin, VectorMultiply(VY, Cos))), &VelocityY[Slot]);
+		VectorStoreAligned(VectorMultiplyAdd(UZ, AlongUp, VectorMultiplyAdd(CrossZ, Sin, VectorMultiply(VZ, Cos))), &VelocityZ[Slot]);
+		VectorStoreAligned(Angle, &RotationAngle[Slot]);
+	}
+}
+
+void FGoKartKinematicsBatch::IntegrateForces(int32 Slot) 
+{
+	FGoKartKinematicsStep Step = FGoKartKinematics::IntegrateForces(GetTuning(Slot), GetVelocity(Slot), GetMove(Slot));
+	SetVelocity(Slot, Step.Velocity);
+	SetTranslation(Slot, Step.Translation);
+}
+
+void FGoKartKinematicsBatch::IntegrateRotation(int32 Slot) 
+{
+	FGoKartKinematicsInput Move = GetMove(Slot);
+	float Angle = FGoKartKinematics::GetRotationAngle(GetTuning(Slot), GetTranslation(Slot), Move);
+	SetVelocity(Slot, FGoKartKinematics::RotateVelocity(GetVelocity(Slot), Move.Up, Angle));
+	RotationAngle[Slot] = Angle;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Tuning for one kart, stored as the values the integrator actually uses
+struct GOKARTKINEMATICS_API FGoKartKinematicsTuning
+{
+	float MaxDrivingForce = 0;
+	float InverseMass = 0;
+	float DragCoefficient = 0;
+	// RollingResistanceCoefficient * NormalForce, constant because our karts stay on the ground
+	float RollingResistanceForce = 0;
+	float InverseTurningRadius = 0;
+	// Most integration steps one move can be split into, 1 is a single explicit Euler step per move
+	int32 MaxSubsteps = 1;
+
+	static FGoKartKinematicsTuning Make(float Mass, float MaxDrivingForce, float DragCoefficient, float RollingResistanceCoefficient, float MinTurningRadius, float GravityAcceleration);
+};
+
+// One move's worth of input, with the kart's orientation at the start of it
+struct FGoKartKinematicsInput
+{
+	FVector Forward = FVector::ForwardVector;
+	FVector Up = FVector::UpVector;
+	float Throttle = 0;
+	float SteeringThrow = 0;
+	float DeltaTime = 0;
+};
+
+// Everything one move does to a kart that isn't blocked by anything
+struct FGoKartKinematicsStep
+{
+	// Velocity (m/s) at the end of the move
+	FVector Velocity = FVector::ZeroVector;
+	// Offset to move the kart by over the move (cm)
+	FVector Translation = FVector::ZeroVector;
+	// Rotation about Up (radians)
+	float RotationAngle = 0;
+};
+
+// The kart movement math on its own - plain values in and out, no allocation, and a module of its own that depends on
+// nothing but Core, so the game and the standalone GoKartKinematicsBenchmark program share it. The Movement Component
+// runs it (through the scalar path of FGoKartKinematicsBatch) one stage at a time so it can sweep for collisions between
+// moving and turning; Step() is the whole move for code with no world to collide with, e.g. the kinematics benchmark.
+//
+// With MaxSubsteps above 1 a long move is integrated in as many substeps as it takes for drag to change our speed by no
+// more than SubstepDragResponse each, and resistance can bring the kart to a stop but never push it backwards. Short
+// moves still take a single step, so this only costs anything when the frame rate drops or a move is long.
+struct GOKARTKINEMATICS_API FGoKartKinematics
+{
+	static constexpr float SubstepDragResponse = 0.1f;
+
+	// How many substeps IntegrateForces splits this move into
+	static int32 GetSubstepCount(const FGoKartKinematicsTuning& Tuning, const FVector& Velocity, const FGoKartKinematicsInput& Input);
+	// The same for four karts at once (as floats), from their velocity, driving force (MaxDrivingForce * Throttle), drag
+	// coefficient, inverse mass, move DeltaTime and MaxSubsteps. GetSubstepCount runs this on one lane, so the scalar
+	// and SIMD paths always split a move the same way - even right on a substep boundary.
+	static VectorRegister GetSubstepCounts(VectorRegister VX, VectorRegister VY, VectorRegister VZ, VectorRegister DrivingForce,
+		VectorRegister DragCoefficient, VectorRegister InverseMass, VectorRegister DeltaTime, VectorRegister MaxSubsteps);
+	// Apply driving force, air resistance and rolling resistance to Velocity, returning the new Velocity and the
+	// Translation the kart makes along the way (RotationAngle is left at 0)
+	static FGoKartKinematicsStep IntegrateForces(const FGoKartKinematicsTuning& Tuning, const FVector& Velocity, const FGoKartKinematicsInput& Input);
+	// How far round its turning circle (radians) the kart gets by moving Translation (cm)
+	static float GetRotationAngle(const FGoKartKinematicsTuning& Tuning, const FVector& Translation, const FGoKartKinematicsInput& Input);
+	// Turn Velocity by RotationAngle about Up
+	static FVector RotateVelocity(const FVector& Velocity, const FVector& Up, float RotationAngle);
+
+	static FGoKartKinematicsStep Step(const FGoKartKinematicsTuning& Tuning, const FVector& Velocity, const FGoKartKinematicsInput& Input);
+};
+
+FORCEINLINE VectorRegister FGoKartKinematics::GetSubstepCounts(VectorRegister VX, VectorRegister VY, VectorRegister VZ, VectorRegister DrivingForce,
+	VectorRegister DragCoefficient, VectorRegister InverseMass, VectorRegister DeltaTime, VectorRegister MaxSubsteps)
+{
+	const VectorRegister One = VectorOne();
+	// Drag changes our speed at d(Drag * v^2 / m)/dv = 2 * Drag * v / m per second for each m/s. Throttle can take us up
+	// to terminal speed within the move, so take whichever of that and our current speed is higher.
+	VectorRegister TerminalSpeedSquared = VectorDivide(VectorAbs(DrivingForce), VectorMax(DragCoefficient, VectorSetFloat1(SMALL_NUMBER)));
+	VectorRegister SpeedSquared = VectorMax(VectorMultiplyAdd(VX, VX, VectorMultiplyAdd(VY, VY, VectorMultiply(VZ, VZ))), TerminalSpeedSquared);
+	VectorRegister Speed = VectorSelect(VectorCompareGT(SpeedSquared, VectorZero()), VectorMultiply(SpeedSquared, VectorReciprocalSqrtAccurate(SpeedSquared)), VectorZero());
+	VectorRegister DragResponse = VectorMultiply(VectorMultiply(VectorMultiply(VectorMultiply(VectorSetFloat1(2), DragCoefficient), Speed), InverseMass), DeltaTime);
+	// Round up, then clamp to [1, MaxSubsteps] - karts with MaxSubsteps of 1 (or free batch slots, 0) take a single step
+	VectorRegister Count = VectorDivide(DragResponse, VectorSetFloat1(SubstepDragResponse));
+	VectorRegister Truncated = VectorTruncate(Count);
+	Count = VectorAdd(Truncated, VectorSelect(VectorCompareGT(Count, Truncated), One, VectorZero()));
+	return VectorMax(VectorMin(Count, MaxSubsteps), One);
+}
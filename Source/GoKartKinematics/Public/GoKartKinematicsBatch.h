@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GoKartKinematics.h"
+
+// Velocity, heading and tuning for every kart in a world, stored as structure-of-arrays so the
+// force and turning math can run four karts at a time with SIMD.
+// A kart without a staged move (DeltaTime of 0) is left untouched by every integrate call.
+class GOKARTKINEMATICS_API FGoKartKinematicsBatch
+{
+public:
+	int32 AddKart();
+	void RemoveKart(int32 Slot);
+
+	FGoKartKinematicsTuning GetTuning(int32 Slot) const;
+	void SetTuning(int32 Slot, const FGoKartKinematicsTuning& Tuning);
+	FVector GetVelocity(int32 Slot) const;
+	void SetVelocity(int32 Slot, const FVector& Velocity);
+	// Offset (cm) the last IntegrateForces moved the kart by, which IntegrateRotation turns it for
+	FVector GetTranslation(int32 Slot) const;
+	void SetTranslation(int32 Slot, const FVector& Translation);
+	// Rotation about the kart's Up vector (radians) produced by the last IntegrateRotation
+	float GetRotationAngle(int32 Slot) const;
+
+	FGoKartKinematicsInput GetMove(int32 Slot) const;
+	void SetMove(int32 Slot, const FVector& Forward, const FVector& Up, float Throttle, float SteeringThrow, float DeltaTime);
+	void ClearMove(int32 Slot);
+	void ClearMoves();
+
+	// Number of slots including free ones, always a multiple of 4
+	int32 GetCapacity() const
+	{
+		return Capacity;
+	}
+	SIZE_T GetAllocatedSize() const;
+
+	// Apply driving force, air resistance and rolling resistance to the velocity of every kart
+	void IntegrateForces();
+	// Turn the velocity of every kart around its turning circle
+	void IntegrateRotation();
+	// Range versions so the batch can be split across threads, BeginSlot must be a multiple of 4
+	void IntegrateForcesInRange(int32 BeginSlot, int32 EndSlot);
+	void IntegrateRotationInRange(int32 BeginSlot, int32 EndSlot);
+	// Scalar versions for a single kart, running FGoKartKinematics
+	void IntegrateForces(int32 Slot);
+	void IntegrateRotation(int32 Slot);
+
+private:
+	using FAlignedFloatArray = TArray<float, TAlignedHeapAllocator<16>>;
+
+	// Per kart state
+	FAlignedFloatArray VelocityX, VelocityY, VelocityZ;
+	// Per move outputs
+	FAlignedFloatArray TranslationX, TranslationY, TranslationZ;
+	FAlignedFloatArray RotationAngle;
+	// Per move inputs
+	FAlignedFloatArray ForwardX, ForwardY, ForwardZ;
+	FAlignedFloatArray UpX, UpY, UpZ;
+	FAlignedFloatArray Throttle, SteeringThrow, DeltaTime;
+	// Tuning
+	FAlignedFloatArray MaxDrivingForce, InverseMass, DragCoefficient, RollingResistanceForce, InverseTurningRadius, MaxSubsteps;
+
+	TArray<int32> FreeSlots;
+	// Always a multiple of 4 so every SIMD load is full and aligned
+	int32 Capacity = 0;
+
+	void Grow();
+};
@@ -1,4 +1,9 @@
 #include "KrazyKarts/Components/GoKartMovementComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "KrazyKarts/Simulation/GoKartInputTrace.h"
+#include "KrazyKarts/Simulation/GoKartSimulationSubsystem.h"
+#include "KrazyKarts/Simulation/GoKartStats.h"
+#include "KrazyKarts/Simulation/GoKartTuning.h"
 
 UGoKartMovementComponent::UGoKartMovementComponent()
 {
@@ -8,6 +13,7 @@ UGoKartMovementComponent::UGoKartMovementComponent()
 void UGoKartMovementComponent::BeginPlay()
 {
 	Super::BeginPlay();
+	ResetRenderInterpolation();
 	// Disable Tick altogether if we're a SimulatedProxy - no need to simulate local moves
 	if (GetOwnerRole() == ROLE_SimulatedProxy) 
 	{
@@ -15,17 +21,91 @@ void UGoKartMovementComponent::BeginPlay()
 	}
 }
 
-void UGoKartMovementComponent::DoTick(float DeltaTime) 
+// Take a slot in the world's kinematics batch as soon as we're registered, replicated state can arrive before BeginPlay
+void UGoKartMovementComponent::OnRegister() 
 {
+	Super::OnRegister();
+	UWorld* World = GetWorld();
+	Simulation = World != nullptr ? World->GetSubsystem<UGoKartSimulationSubsystem>() : nullptr;
+	if (Simulation == nullptr) return;
+	KinematicsSlot = Simulation->GetKinematics().AddKart();
+	RefreshTuning();
+}
+
+void UGoKartMovementComponent::OnUnregister() 
+{
+	if (Simulation != nullptr) 
+	{
+		Simulation->GetKinematics().RemoveKart(KinematicsSlot);
+		Simulation = nullptr;
+		KinematicsSlot = INDEX_NONE;
+	}
+	Super::OnUnregister();
+}
+
+const UGoKartTuning* UGoKartMovementComponent::GetTuning() const
+{
+	return Tuning != nullptr ? Tuning : GetDefault<UGoKartTuning>();
+}
+
+void UGoKartMovementComponent::RefreshTuning() 
+{
+	if (Simulation == nullptr) return;
+	// Get Unreal's Gravity variable and convert to meters
+	float GravityAcceleration = -GetWorld()->GetGravityZ() / 100;
+	Simulation->GetKinematics().SetTuning(KinematicsSlot, GetTuning()->GetKinematicsTuning(GravityAcceleration));
+}
+
+void UGoKartMovementComponent::CreateMoves(float DeltaTime) 
+{
+	PendingMoves.Reset();
 	// Gather information about our Role and RemoteRole
 	auto ControlledPawn = Cast<APawn>(GetOwner());
 	bool ServerControlled = GetOwnerRole() == ROLE_Authority && ControlledPawn != nullptr && ControlledPawn->IsLocallyControlled();
-	// Simulate our movement locally if we are in control of our Owner's Pawn
-	if (GetOwnerRole() == ROLE_AutonomousProxy || ServerControlled)
+	// Only create moves if we are in control of our Owner's Pawn, the simulation subsystem simulates them for us
+	if (GetOwnerRole() != ROLE_AutonomousProxy && !ServerControlled) return;
+	if (!bUseFixedTimestep) 
 	{
 		LastMove = CreateMove(DeltaTime);
-		SimulateMove(LastMove);
+		PendingMoves.Add(LastMove);
+		return;
+	}
+	// Emit as many fixed steps as fit into our accumulated time, the remainder carries over to the next frame
+	float FixedDeltaTime = 1.f / FixedTimestepRate;
+	FixedStepAccumulator += DeltaTime;
+	while (FixedStepAccumulator >= FixedDeltaTime && PendingMoves.Num() < MaxFixedStepsPerFrame) 
+	{
+		LastMove = CreateMove(FixedDeltaTime);
+		PendingMoves.Add(LastMove);
+		FixedStepAccumulator -= FixedDeltaTime;
 	}
+	FixedStepAccumulator = FMath::Min(FixedStepAccumulator, FixedDeltaTime);
+}
+
+void UGoKartMovementComponent::AddRemoteMove(const FGoKartMove& Move) 
+{
+	PendingMoves.Add(Move);
+}
+
+void UGoKartMovementComponent::OnLocalMoveSimulated() 
+{
+	PreviousStepTransform = CurrentStepTransform;
+	CurrentStepTransform = GetOwner()->GetActorTransform();
+}
+
+void UGoKartMovementComponent::ResetRenderInterpolation() 
+{
+	PreviousStepTransform = GetOwner()->GetActorTransform();
+	CurrentStepTransform = PreviousStepTransform;
+}
+
+FTransform UGoKartMovementComponent::GetRenderTransform() const
+{
+	// Alpha is how far we are through the next fixed step we haven't simulated yet
+	float Alpha = FMath::Clamp(FixedStepAccumulator * FixedTimestepRate, 0.f, 1.f);
+	FTransform RenderTransform;
+	RenderTransform.Blend(PreviousStepTransform, CurrentStepTransform, Alpha);
+	return RenderTransform;
 }
 
 FGoKartMove UGoKartMovementComponent::CreateMove(float DeltaTime) 
@@ -33,82 +113,96 @@ FGoKartMove UGoKartMovementComponent::CreateMove(float DeltaTime)
 	FGoKartMove NewMove;
 	NewMove.Throttle = Throttle;
 	NewMove.SteeringThrow = SteeringThrow;
-	NewMove.DeltaTime = DeltaTime;
-	NewMove.Timestamp = GetWorld()->GetTimeSeconds();
+	NewMove.DeltaTime = DeltaTime + DeltaTimeRemainder;
+	NewMove.MoveId = NextMoveId;
+	NextMoveId = FGoKartMove::GetNextMoveId(NextMoveId);
+	// Simulate exactly what the Server will see, carrying any rounding error into our next move
+	NewMove.Quantize();
+	float QuantizationStep = 1.f / FGoKartMove::DeltaTimeStepsPerSecond;
+	DeltaTimeRemainder = FMath::Clamp(DeltaTime + DeltaTimeRemainder - NewMove.DeltaTime, -QuantizationStep, QuantizationStep);
+	if (InputTrace.IsValid()) 
+	{
+		InputTrace->WriteMove(NewMove);
+	}
 	return NewMove;
 }
 
-void UGoKartMovementComponent::SimulateMove(const FGoKartMove& Move) 
+void UGoKartMovementComponent::SimulateMove(const FGoKartMove& Move, EGoKartCollisionQuery CollisionQuery) 
 {
-	// Create our "driving force" by taking our input * driving force * forward
-	FVector Force = GetOwner()->GetActorForwardVector() * MaxDrivingForce * Move.Throttle;
-	// Calculate and apply air resistance to our driving force
-	Force += CalculateAirResistance();
-	Force += CalculateRollingResistance();
-	// Find Acceleration using F = M/A
-	FVector Acceleration = Force / Mass;
-	// Find Velocity based on our Acceleration and time traveled Dv = a * Dt
-	Velocity += Acceleration * Move.DeltaTime;
+	if (Simulation == nullptr) return;
+	SCOPE_CYCLE_COUNTER(STAT_GoKart_SimulateMove);
+	FGoKartKinematicsBatch& Kinematics = Simulation->GetKinematics();
+	StageMove(Move);
+	// Apply driving force, air and rolling resistance to our Velocity
+	Kinematics.IntegrateForces(KinematicsSlot);
 	// Perform movement and rotations
-	UpdateLocationViaVelocity(Move.DeltaTime);
-	ApplyRotation(Move.DeltaTime, Move.SteeringThrow);
+	UpdateLocationViaVelocity(CollisionQuery);
+	Kinematics.IntegrateRotation(KinematicsSlot);
+	ApplyRotation();
+	Kinematics.ClearMove(KinematicsSlot);
 }
 
-void UGoKartMovementComponent::ApplyRotation(float DeltaTime, float MoveSteeringThrow) 
+void UGoKartMovementComponent::StageMove(const FGoKartMove& Move) 
 {
-	// dX - change in location along our turning circle over time
-	float DeltaLocation = FVector::DotProduct(GetOwner()->GetActorForwardVector(), Velocity) * DeltaTime;
-	// dTheta = dX / R (change in angle around the circle over time)
-	float dTheta = DeltaLocation / MinTurningRadius;
-	// Rotation Angle (radians) = dTheta * User Input
-	float RotationAngleRadians = dTheta * MoveSteeringThrow;
-	// Build an FQuat for our rotation about the Up vector
+	LastSimulatedSteeringThrow = Move.SteeringThrow;
+	Simulation->GetKinematics().SetMove(KinematicsSlot, GetOwner()->GetActorForwardVector(), GetOwner()->GetActorUpVector(), Move.Throttle, Move.SteeringThrow, Move.DeltaTime);
+}
+
+void UGoKartMovementComponent::ApplyRotation() 
+{
+	// Build an FQuat for the rotation about the Up vector the kinematics worked out for us
+	float RotationAngleRadians = Simulation->GetKinematics().GetRotationAngle(KinematicsSlot);
 	FQuat RotationDelta(GetOwner()->GetActorUpVector(), RotationAngleRadians);
-	// Rotate our Velocity vector by our rotation
-	Velocity = RotationDelta.RotateVector(Velocity);
-	// Apply our rotation
 	GetOwner()->AddActorWorldRotation(RotationDelta);
 }
 
-void UGoKartMovementComponent::UpdateLocationViaVelocity(float DeltaTime) 
+void UGoKartMovementComponent::UpdateLocationViaVelocity(EGoKartCollisionQuery CollisionQuery) 
 {
-	// Translate our Velocity into a movement vector accounting for changing our m/s scale into cm/s Unreal units
-	FVector Translation = (Velocity * DeltaTime * 100);
-	// Move the car, sweeping for collisions
+	FGoKartKinematicsBatch& Kinematics = Simulation->GetKinematics();
+	FVector Translation = Kinematics.GetTranslation(KinematicsSlot);
 	FHitResult OutHit;
-	GetOwner()->AddActorWorldOffset(Translation, true, &OutHit);
+	auto KartPrimitive = Cast<UPrimitiveComponent>(GetOwner()->GetRootComponent());
+	bool bUseCache = CollisionQuery == EGoKartCollisionQuery::Cached && bUseCollisionCache && KartPrimitive != nullptr;
+	float Now = GetWorld()->GetTimeSeconds();
+	FVector Start = GetOwner()->GetActorLocation();
+	if (bUseCache && CollisionCache.Sweep(KartPrimitive, Start, Start + Translation, Now, OutHit)) 
+	{
+		// The cache already swept (and pulled back) for us, move straight to wherever it stopped us
+		GetOwner()->SetActorLocation(OutHit.Location);
+		if (OutHit.bBlockingHit) 
+		{
+			KartPrimitive->DispatchBlockingHit(*GetOwner(), OutHit);
+		}
+	}
+	else 
+	{
+		// Move the car, sweeping for collisions
+		GetOwner()->AddActorWorldOffset(Translation, true, &OutHit);
+		// Refresh the neighborhood around our new location for the next cached move
+		if (bUseCache) 
+		{
+			CollisionCache.Build(KartPrimitive, Now);
+		}
+	}
 	// Check if we did have a collision
 	if (OutHit.IsValidBlockingHit()) 
 	{
-		Velocity = FVector::ZeroVector;
+		// Stop dead, without turning for the distance we didn't get to travel
+		SetVelocity(FVector::ZeroVector);
+		Kinematics.SetTranslation(KinematicsSlot, FVector::ZeroVector);
 	}
 }
 
-FVector UGoKartMovementComponent::CalculateAirResistance() 
-{
-	// Air Resistance = -Speed^2 * DragCoefficient
-	return (-Velocity.GetSafeNormal() * Velocity.SizeSquared() * DragCoefficient);
-}
-
-FVector UGoKartMovementComponent::CalculateRollingResistance() 
-{
-	// Get Unreal's Gravity variable and convert to meters
-	float GravityAcceleration = -GetWorld()->GetGravityZ() / 100;
-	// F = m * g
-	float NormalForce = Mass * GravityAcceleration;
-	// RollingResistance = RRCoefficient * NormalForce
-	// -Velocity.GetSafeNormal() is here because the force is applied opposite of the Velocity
-	return -Velocity.GetSafeNormal() * RollingResistanceCoefficient * NormalForce;
-}
-
 FVector UGoKartMovementComponent::GetVelocity() const
 {
-	return Velocity;
+	if (Simulation == nullptr) return FVector::ZeroVector;
+	return Simulation->GetKinematics().GetVelocity(KinematicsSlot);
 }
 
 void UGoKartMovementComponent::SetVelocity(FVector NewVelocity) 
 {
-	Velocity = NewVelocity;	
+	if (Simulation == nullptr) return;
+	Simulation->GetKinematics().SetVelocity(KinematicsSlot, NewVelocity);
 }
 
 void UGoKartMovementComponent::SetThrottle(float Value) 
@@ -121,7 +215,78 @@ void UGoKartMovementComponent::SetSteeringThrow(float Value)
 	SteeringThrow = Value;
 }
 
+void UGoKartMovementComponent::StartInputTrace(const FString& Name) 
+{
+	InputTrace = MakeShareable(FGoKartInputTraceWriter::Create(Name).Release());
+	if (!InputTrace.IsValid()) 
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Couldn't open input trace %s"), *FGoKartInputTraceWriter::GetTracePath(Name));
+		return;
+	}
+	// Playback starts from wherever we are now
+	FGoKartTraceState Start;
+	Start.Location = GetOwner()->GetActorLocation();
+	Start.Rotation = GetOwner()->GetActorQuat();
+	Start.Velocity = GetVelocity();
+	InputTrace->WriteStart(Start);
+	UE_LOG(LogTemp, Display, TEXT("Recording input trace to %s"), *InputTrace->GetPath());
+}
+
+void UGoKartMovementComponent::StopInputTrace() 
+{
+	InputTrace.Reset();
+}
+
 FGoKartMove& UGoKartMovementComponent::GetLastMove() 
 {
 	return LastMove;
+}
+
+void FGoKartMove::Quantize() 
+{
+	Throttle = DequantizeAxis(QuantizeAxis(Throttle));
+	SteeringThrow = DequantizeAxis(QuantizeAxis(SteeringThrow));
+	DeltaTime = DequantizeDeltaTime(QuantizeDeltaTime(DeltaTime));
+}
+
+bool FGoKartMove::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) 
+{
+	// 7 + 7 + 10 + 16 = 40 bits per move instead of four 32 bit floats
+	uint32 PackedThrottle = Ar.IsSaving() ? QuantizeAxis(Throttle) : 0;
+	uint32 PackedSteeringThrow = Ar.IsSaving() ? QuantizeAxis(SteeringThrow) : 0;
+	uint32 PackedDeltaTime = Ar.IsSaving() ? QuantizeDeltaTime(DeltaTime) : 0;
+	Ar.SerializeInt(PackedThrottle, AxisMax);
+	Ar.SerializeInt(PackedSteeringThrow, AxisMax);
+	Ar.SerializeInt(PackedDeltaTime, DeltaTimeMax);
+	Ar << MoveId;
+	if (Ar.IsLoading()) 
+	{
+		Throttle = DequantizeAxis(PackedThrottle);
+		SteeringThrow = DequantizeAxis(PackedSteeringThrow);
+		DeltaTime = DequantizeDeltaTime(PackedDeltaTime);
+	}
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+uint32 FGoKartMove::QuantizeAxis(float Value) 
+{
+	// Map [-1, 1] onto [0, 2 * AxisSteps] so that -1, 0 and 1 are all exactly representable
+	int32 Steps = FMath::RoundToInt(FMath::Clamp(Value, -1.f, 1.f) * AxisSteps);
+	return static_cast<uint32>(Steps + static_cast<int32>(AxisSteps));
+}
+
+float FGoKartMove::DequantizeAxis(uint32 Value) 
+{
+	return (static_cast<int32>(Value) - static_cast<int32>(AxisSteps)) / static_cast<float>(AxisSteps);
+}
+
+uint32 FGoKartMove::QuantizeDeltaTime(float Value) 
+{
+	return static_cast<uint32>(FMath::Clamp(FMath::RoundToInt(Value * DeltaTimeStepsPerSecond), 0, static_cast<int32>(DeltaTimeMax) - 1));
+}
+
+float FGoKartMove::DequantizeDeltaTime(uint32 Value) 
+{
+	return Value / static_cast<float>(DeltaTimeStepsPerSecond);
 }
\ No newline at end of file
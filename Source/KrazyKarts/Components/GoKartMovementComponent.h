@@ -2,8 +2,13 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "KrazyKarts/Simulation/GoKartCollisionCache.h"
 #include "GoKartMovementComponent.generated.h"
 
+class UGoKartSimulationSubsystem;
+class UGoKartTuning;
+class FGoKartInputTraceWriter;
+
 USTRUCT()
 struct FGoKartMove
 {
@@ -15,13 +20,75 @@ struct FGoKartMove
 	float SteeringThrow;
 	UPROPERTY()
 	float DeltaTime;
+	// Wrapping sequence number the Server echoes back to acknowledge this move
 	UPROPERTY()
-	float Timestamp;
+	uint16 MoveId = 0;
+
+	// Throttle and SteeringThrow are sent as 7 bit fixed point values in [-1, 1]
+	static constexpr uint32 AxisSteps = 63;
+	static constexpr uint32 AxisMax = 2 * AxisSteps + 1;
+	// DeltaTime is sent as a 10 bit count of milliseconds
+	static constexpr uint32 DeltaTimeStepsPerSecond = 1000;
+	static constexpr uint32 DeltaTimeMax = 1 << 10;
 
-	bool IsValid()
+	bool IsValid() const
 	{
 		return FMath::Abs(Throttle) <= 1 && FMath::Abs(SteeringThrow) <= 1;
 	}
+
+	// DeltaTime as a whole number of milliseconds, which is exactly what was sent so it sums without drift
+	uint32 GetDeltaTicks() const
+	{
+		return QuantizeDeltaTime(DeltaTime);
+	}
+
+	// Round our values to what the Server will receive so both sides simulate the same move
+	void Quantize();
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	// True if move A was created after move B, accounting for the sequence number wrapping around
+	static bool IsNewerMoveId(uint16 A, uint16 B)
+	{
+		return static_cast<int16>(A - B) > 0;
+	}
+
+	// MoveIds count up from 1 and skip 0 when they wrap, it's reserved for "no move acknowledged yet"
+	static uint16 GetNextMoveId(uint16 MoveId)
+	{
+		return MoveId == MAX_uint16 ? 1 : MoveId + 1;
+	}
+
+	// How many moves after From the move To is (negative if before), not counting the skipped 0
+	static int32 GetMoveIdDistance(uint16 From, uint16 To)
+	{
+		int32 Distance = static_cast<int16>(To - From);
+		if (Distance > 0 && To < From) return Distance - 1;
+		if (Distance < 0 && To > From) return Distance + 1;
+		return Distance;
+	}
+
+	static uint32 QuantizeAxis(float Value);
+	static float DequantizeAxis(uint32 Value);
+	static uint32 QuantizeDeltaTime(float Value);
+	static float DequantizeDeltaTime(uint32 Value);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGoKartMove> : public TStructOpsTypeTraitsBase2<FGoKartMove>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+// How a simulated move checks for collisions
+enum class EGoKartCollisionQuery : uint8
+{
+	// Sweep against the full physics scene
+	Scene,
+	// Sweep against our cached collision neighborhood, falling back to the scene when the cache can't answer
+	Cached
 };
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
@@ -31,44 +98,97 @@ class KRAZYKARTS_API UGoKartMovementComponent : public UActorComponent
 
 public:	
 	UGoKartMovementComponent();
-	void DoTick(float DeltaTime);
-	void SimulateMove(const FGoKartMove& Move);
+	// Create this frame's moves if we're in control of our Owner's Pawn - one move per frame, or with a fixed timestep
+	// however many fixed steps fit into the time we've accumulated
+	void CreateMoves(float DeltaTime);
+	// Server - queue a move received from our owning client to be simulated along with everyone else's this frame
+	void AddRemoteMove(const FGoKartMove& Move);
+	const TArray<FGoKartMove, TInlineAllocator<8>>& GetPendingMoves() const
+	{
+		return PendingMoves;
+	}
+	void ClearPendingMoves()
+	{
+		PendingMoves.Reset();
+	}
+	// Called once each of our pending moves has been simulated, to track the states we render between
+	void OnLocalMoveSimulated();
+	// Drop render interpolation history, e.g. after being corrected by the Server
+	void ResetRenderInterpolation();
+	bool IsUsingFixedTimestep() const
+	{
+		return bUseFixedTimestep;
+	}
+	// Where to draw the kart when using a fixed timestep, between the last two simulated states
+	FTransform GetRenderTransform() const;
+	void SimulateMove(const FGoKartMove& Move, EGoKartCollisionQuery CollisionQuery = EGoKartCollisionQuery::Scene);
 
 	FGoKartMove& GetLastMove();
 	FVector GetVelocity() const;
 	void SetVelocity(FVector NewVelocity);
 	void SetThrottle(float Value);
 	void SetSteeringThrow(float Value);
+	// Steering of the last move we simulated, whoever created it
+	float GetLastSimulatedSteeringThrow() const
+	{
+		return LastSimulatedSteeringThrow;
+	}
+	const UGoKartTuning* GetTuning() const;
+	// Push our tuning to the kinematics batch again, e.g. after the asset has been edited
+	void RefreshTuning();
+	// Record every move we create (and every ServerState our Replication Component receives) to an input trace
+	void StartInputTrace(const FString& Name);
+	void StopInputTrace();
+	FGoKartInputTraceWriter* GetInputTrace() const
+	{
+		return InputTrace.Get();
+	}
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
 
 private:
-	// Mass of car in kg
-	UPROPERTY(EditAnywhere)
-	float Mass = 1000;
-	// The force applied to the car when the throttle is down
-	UPROPERTY(EditAnywhere)
-	float MaxDrivingForce = 10000;
-	// The amount of drag applied to the car when calculating Air Resistance (kg/m)
-	UPROPERTY(EditAnywhere)
-	float DragCoefficient = 16;
-	// The rolling resistance that our tires exert.
-	UPROPERTY(EditAnywhere)
-	float RollingResistanceCoefficient = 0.015f;
-	// The minimum radius of our turning circle at full turn (meters).
-	UPROPERTY(EditAnywhere)
-	float MinTurningRadius = 10;
-
-	FVector Velocity;
+	friend class UGoKartSimulationSubsystem;
+
+	// How we drive, shared with every other kart using the same asset. None drives with the UGoKartTuning defaults.
+	UPROPERTY(EditAnywhere, Category="Tuning")
+	UGoKartTuning* Tuning;
+	// Create moves at a fixed rate instead of once per rendered frame, rendering between the last two simulated states
+	UPROPERTY(EditAnywhere, Category="Simulation")
+	bool bUseFixedTimestep = false;
+	UPROPERTY(EditAnywhere, Category="Simulation", meta=(EditCondition="bUseFixedTimestep", ClampMin="10", ClampMax="120"))
+	float FixedTimestepRate = 60;
+	// After a hitch we drop time rather than trying to catch up with more than this many steps in one frame
+	UPROPERTY(EditAnywhere, Category="Simulation", meta=(EditCondition="bUseFixedTimestep", ClampMin="1"))
+	int32 MaxFixedStepsPerFrame = 4;
+	// Let driven, replayed and Server simulated moves sweep against a cached collision neighborhood instead of the scene
+	UPROPERTY(EditAnywhere, Category="Collision")
+	bool bUseCollisionCache = true;
+
+	// Our velocity and tuning live in the world's kinematics batch, we're a view over our slot in it
+	UPROPERTY()
+	UGoKartSimulationSubsystem* Simulation;
+	int32 KinematicsSlot = INDEX_NONE;
+	FGoKartCollisionCache CollisionCache;
 	float Throttle = 0;
 	float SteeringThrow = 0;
+	float LastSimulatedSteeringThrow = 0;
 	FGoKartMove LastMove;
+	TArray<FGoKartMove, TInlineAllocator<8>> PendingMoves;
+	float FixedStepAccumulator = 0;
+	FTransform PreviousStepTransform;
+	FTransform CurrentStepTransform;
+	// Sequence number for the next move we create (0 is reserved for "no move acknowledged yet")
+	uint16 NextMoveId = 1;
+	// Frame time lost to DeltaTime quantization, carried into the next move so no time is dropped
+	float DeltaTimeRemainder = 0;
+	TSharedPtr<FGoKartInputTraceWriter> InputTrace;
 
 	FGoKartMove CreateMove(float DeltaTime);
-	FVector CalculateAirResistance();
-	FVector CalculateRollingResistance();
-	void UpdateLocationViaVelocity(float DeltaTime);
-	void ApplyRotation(float DeltaTime, float MoveSteeringThrow);
+	void StageMove(const FGoKartMove& Move);
+	void UpdateLocationViaVelocity(EGoKartCollisionQuery CollisionQuery);
+	void ApplyRotation();
 		
 };
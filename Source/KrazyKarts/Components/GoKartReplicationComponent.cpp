@@ -1,6 +1,20 @@
 
 #include "KrazyKarts/Components/GoKartReplicationComponent.h"
 #include "Net/UnrealNetwork.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Serialization/BitWriter.h"
+#include "KrazyKarts/Simulation/GoKartInputTrace.h"
+#include "KrazyKarts/Simulation/GoKartSimulationSubsystem.h"
+#include "KrazyKarts/Simulation/GoKartStats.h"
+
+static_assert(FGoKartMove::DeltaTimeStepsPerSecond == FGoKartNetClock::TicksPerSecond, "Move DeltaTime must be a whole number of clock ticks");
+
+static TAutoConsoleVariable<int32> CVarCompareStateBandwidth(
+	TEXT("kart.Net.CompareStateBandwidth"),
+	0,
+	TEXT("When 1 the Server logs, per kart, an estimate of the average size of each ServerState update in the compact format vs the old full precision format."),
+	ECVF_Default);
 
 UGoKartReplicationComponent::UGoKartReplicationComponent()
 {
@@ -24,92 +38,324 @@ void UGoKartReplicationComponent::GetLifetimeReplicatedProps(TArray<FLifetimePro
     DOREPLIFETIME(UGoKartReplicationComponent, ServerState);
 }
 
+void UGoKartReplicationComponent::OnMoveSimulated(const FGoKartMove& Move) 
+{
+	if (MovementComponent == nullptr) return;
+	// Autonomous proxy - Clients controlling pawn
+	if (GetOwnerRole() == ROLE_AutonomousProxy) 
+	{
+		FGoKartPredictedMove Prediction;
+		Prediction.Move = Move;
+		RecordPrediction(Prediction);
+		AddUnacknowledgedMove(Prediction);
+	}
+	// Server - our own move or one of our client's, either way it's already simulated
+	else if (GetOwnerRole() == ROLE_Authority) 
+	{
+		// Only the last move of the frame is published, from DoTick
+		ServerStateMove = Move;
+		bServerStateDirty = true;
+	}
+}
+
+// Add a move to the list of moves that haven't yet been acknowledged by the Server, and send it
+void UGoKartReplicationComponent::AddUnacknowledgedMove(const FGoKartPredictedMove& Prediction) 
+{
+	if (!UnacknowledgedMoves.Push(Prediction)) 
+	{
+		++UnacknowledgedMoveOverflows;
+		UE_LOG(LogTemp, Warning, TEXT("%s: unacknowledged move buffer full, dropped oldest move (%d total)"), *GetOwner()->GetName(), UnacknowledgedMoveOverflows);
+		// Everything moved down one, including the move our replay is up to
+		if (IsReplaying()) 
+		{
+			NextReplayIndex = FMath::Max(NextReplayIndex - 1, 0);
+		}
+	}
+	// RPC to tell the Server we're moving, batched moves are sent from DoTick
+	if (InputTransport == EGoKartInputTransport::Reliable) 
+	{
+		Server_Move(Prediction.Move);
+		++GetNetCounters().MoveRpcsSent;
+	}
+}
+
+void UGoKartReplicationComponent::DeferMovesWhileReplaying() 
+{
+	DeferredMoveCount = 0;
+	if (!IsReplaying() || MovementComponent == nullptr) return;
+	DeferredMoveCount = MovementComponent->GetPendingMoves().Num();
+	// The Server still gets them straight away, we'll simulate them (and record what we predicted) when the replay
+	// reaches them
+	for (const FGoKartMove& Move : MovementComponent->GetPendingMoves()) 
+	{
+		FGoKartPredictedMove Prediction;
+		Prediction.Move = Move;
+		AddUnacknowledgedMove(Prediction);
+	}
+	MovementComponent->ClearPendingMoves();
+}
+
+void UGoKartReplicationComponent::DequeueClientMoves(float DeltaTime) 
+{
+	if (GetOwnerRole() != ROLE_Authority || MovementComponent == nullptr) return;
+	if (ClientMoveQueue.IsEmpty()) 
+	{
+		// We've run dry, build the buffer back up before draining it again
+		bClientMovesBuffering = true;
+		ClientMoveBudget = 0;
+		return;
+	}
+	float QueuedTime = static_cast<float>(QueuedClientMoveTicks) / FGoKartNetClock::TicksPerSecond;
+	float TargetBufferTime = FMath::Min(ClientMoveJitter * JitterDelayMultiplier, MaxServerJitterBuffer);
+	if (bClientMovesBuffering && QueuedTime < TargetBufferTime) return;
+	bClientMovesBuffering = false;
+	// Drain at the rate time passes, plus a fraction of anything queued beyond the buffer so a backlog is caught up
+	// over a few frames instead of all in one. A client rendering much faster than we tick sends many moves per frame
+	// of ours, but never more than MaxServerMovesPerFrame are simulated at once however short they are.
+	float Backlog = QueuedTime - TargetBufferTime - DeltaTime;
+	ClientMoveBudget += DeltaTime + FMath::Max(Backlog, 0.f) * ServerCatchUpRate;
+	for (int32 Dequeued = 0; Dequeued < MaxServerMovesPerFrame && !ClientMoveQueue.IsEmpty(); ++Dequeued) 
+	{
+		const FGoKartMove& Move = ClientMoveQueue.First();
+		if (Move.DeltaTime > ClientMoveBudget) break;
+		ClientMoveBudget -= Move.DeltaTime;
+		QueuedClientMoveTicks -= Move.GetDeltaTicks();
+		MovementComponent->AddRemoteMove(Move);
+		ClientMoveQueue.PopFront();
+	}
+	// Don't bank time we had no moves to spend on, it would turn into a burst later
+	ClientMoveBudget = FMath::Min(ClientMoveBudget, static_cast<float>(QueuedClientMoveTicks) / FGoKartNetClock::TicksPerSecond);
+}
+
 void UGoKartReplicationComponent::DoTick(float DeltaTime) 
 {
 	// Get our owning Pawn for a check later
 	auto ControlledPawn = Cast<APawn>(GetOwner());
 	if (MovementComponent == nullptr || ControlledPawn == nullptr) return;
-	// Get our latest local Move from the Movement Component
-	FGoKartMove LastMove = MovementComponent->GetLastMove();
-	// Autonomous proxy - Clients controlling pawn
-	if (GetOwnerRole() == ROLE_AutonomousProxy) 
+	bool bAutonomousProxy = GetOwnerRole() == ROLE_AutonomousProxy;
+	bool bServerControlled = GetOwnerRole() == ROLE_Authority && ControlledPawn->IsLocallyControlled();
+	if (bAutonomousProxy && InputTransport == EGoKartInputTransport::UnreliableRedundant) 
 	{
-		// Add our latest move to a list of moves that haven't yet been acknowledged by the Server
-		UnacknowledgedMoves.Add(LastMove);
-		// RPC to tell the Server we're moving
-		Server_Move(LastMove);
+		SendUnacknowledgedMoves(DeltaTime);
 	}
-	// Server controlling it's own pawn
-	else if (GetOwnerRole() == ROLE_Authority && ControlledPawn->IsLocallyControlled()) 
+	if (bAutonomousProxy) 
 	{
-		// Simply update our ServerState - our local movement has already simulated via Movement Component
-		UpdateServerState(LastMove);
+		SendClockSync(DeltaTime);
 	}
-	// Simulated proxy (another connection's pawn)
-	else if (GetOwnerRole() == ROLE_SimulatedProxy) 
+	if (GetOwnerRole() == ROLE_Authority && !bServerControlled && InputTransport == EGoKartInputTransport::UnreliableRedundant) 
+	{
+		SendMoveAck(DeltaTime);
+	}
+	// However many moves we simulated this frame, clients only need the state after the last of them
+	if (bServerStateDirty) 
+	{
+		bServerStateDirty = false;
+		UpdateServerState(ServerStateMove);
+		++GetNetCounters().ServerStatesPublished;
+	}
+	if (bAutonomousProxy && IsReplaying()) 
+	{
+		// Replay more than we just queued so the replay catches up, and give up spreading it once it's taken too long
+		++ReplayFrames;
+		ReplayMoves(ReplayFrames >= MaxSpreadReplayFrames ? 0 : FMath::Max(MaxReplayMovesPerFrame, DeferredMoveCount + 1));
+	}
+	if ((bAutonomousProxy || bServerControlled) && MeshOffsetRoot != nullptr) 
+	{
+		PlaceLocalMesh(DeltaTime);
+	}
+}
+
+// Draw our mesh where we're simulating, eased off any correction we've just had
+void UGoKartReplicationComponent::PlaceLocalMesh(float DeltaTime) 
+{
+	if (IsReplaying()) 
+	{
+		// Our actor is somewhere in the past until the replay catches up, keep going the way we were
+		CorrectionVisualPose.AddToTranslation(CorrectionVisualVelocity * DeltaTime);
+		MeshOffsetRoot->SetWorldTransform(CorrectionVisualPose);
+		return;
+	}
+	bool bFixedTimestep = MovementComponent->IsUsingFixedTimestep();
+	// Otherwise our mesh follows our actor by itself
+	if (!bFixedTimestep && !bHasVisualError) return;
+	// With a fixed timestep our mesh is drawn between the last two simulated states rather than at the latest one
+	FTransform MeshTransform = bFixedTimestep ? MovementComponent->GetRenderTransform() : GetOwner()->GetActorTransform();
+	if (bHasVisualError) 
+	{
+		float Remaining = VisualCorrectionTime > 0 ? FMath::Exp(-DeltaTime / VisualCorrectionTime) : 0;
+		VisualErrorLocation *= Remaining;
+		VisualErrorRotation = FQuat::Slerp(FQuat::Identity, VisualErrorRotation, Remaining);
+		// Once it's too small to see we're back to drawing exactly where we are
+		if (VisualErrorLocation.SizeSquared() < FMath::Square(0.1f) && FMath::RadiansToDegrees(VisualErrorRotation.GetAngle()) < 0.1f) 
+		{
+			VisualErrorLocation = FVector::ZeroVector;
+			VisualErrorRotation = FQuat::Identity;
+			bHasVisualError = false;
+		}
+		MeshTransform.AddToTranslation(VisualErrorLocation);
+		MeshTransform.SetRotation(VisualErrorRotation * MeshTransform.GetRotation());
+	}
+	MeshOffsetRoot->SetWorldTransform(MeshTransform);
+}
+
+// Simulated proxy - pick how much smoothing we're worth from the nearest local view, on the game thread
+void UGoKartReplicationComponent::UpdateProxyLOD(TArrayView<const FVector> ViewLocations) 
+{
+	FVector Location = GetOwner()->GetActorLocation();
+	float NearestDistanceSquared = ViewLocations.Num() > 0 ? MAX_flt : 0;
+	for (const FVector& ViewLocation : ViewLocations) 
+	{
+		NearestDistanceSquared = FMath::Min(NearestDistanceSquared, FVector::DistSquared(ViewLocation, Location));
+	}
+	if (NearestDistanceSquared <= FMath::Square(NearLODDistance)) 
+	{
+		ProxyLOD = EGoKartProxyLOD::Near;
+	}
+	else if (NearestDistanceSquared <= FMath::Square(FarLODDistance)) 
+	{
+		ProxyLOD = EGoKartProxyLOD::Mid;
+	}
+	else 
+	{
+		ProxyLOD = EGoKartProxyLOD::Far;
+	}
+	// Nobody can see the difference on a kart that's off screen or hidden. Without a renderer (-nullrhi, e.g. the load
+	// test's bot clients) nothing is ever rendered, so go by distance alone and cost what a real client would.
+	bProxyRecentlyRendered = !FApp::CanEverRender() || GetOwner()->WasRecentlyRendered(0.25f);
+	if (!bProxyRecentlyRendered) 
 	{
-		ClientTick(DeltaTime);
+		ProxyLOD = EGoKartProxyLOD::Far;
 	}
 }
 
-void UGoKartReplicationComponent::ClientTick(float DeltaTime) 
+// Simulated proxy (another connection's pawn) - may run on a worker thread, so only touches our own state
+void UGoKartReplicationComponent::ClientTick(double ServerTime) 
 {
-	// Increase our ClientTimeSinceLastUpdate with our DeltaTime
-	ClientTimeSinceLastUpdate += DeltaTime;
-	// Safety check to ensure we're not using extremely small floating point numbers
-	if (ClientTimeBetweenUpdates <= KINDA_SMALL_NUMBER) return; 
-	// Create a Spline we can use with our cubic interpolations
-	FHermiteCubicSpline Spline = CreateSpline();
-	// Interpolate location, velocity, and rotation based on our latest received update
-	float Alpha = ClientTimeSinceLastUpdate / ClientTimeBetweenUpdates;
-	InterpolateLocation(Spline, Alpha);
-	InterpolateVelocity(Spline, Alpha);
-	InterpolateRotation(Alpha);
+	SCOPE_CYCLE_COUNTER(STAT_GoKart_ClientTick);
+	bHasClientPose = false;
+	if (Snapshots.IsEmpty() || MovementComponent == nullptr) return;
+	// We render at a point in Server time (ticks) far enough behind to (usually) have a snapshot on either side of it
+	double RenderTime = ServerTime - (ArrivalDelay + InterpolationDelay) * FGoKartNetClock::TicksPerSecond;
+	// Drop snapshots we've rendered past, keeping the one just before RenderTime
+	while (Snapshots.Num() > 2 && Snapshots[1].ServerTicks <= RenderTime) 
+	{
+		Snapshots.PopFront();
+	}
+	const FGoKartSnapshot& From = Snapshots.First();
+	const FGoKartSnapshot& To = Snapshots.Last();
+	if (Snapshots.Num() == 1 || RenderTime >= To.ServerTicks) 
+	{
+		// Our snapshots are late, carry on along the newest one for a little while
+		Extrapolate(To, (RenderTime - To.ServerTicks) / FGoKartNetClock::TicksPerSecond);
+	}
+	else if (RenderTime <= From.ServerTicks) 
+	{
+		Extrapolate(From, 0);
+	}
+	else 
+	{
+		// Interpolate location, velocity, and rotation between the two snapshots either side of RenderTime
+		const FGoKartSnapshot& Next = Snapshots[1];
+		int64 DurationTicks = Next.ServerTicks - From.ServerTicks;
+		float Duration = static_cast<float>(DurationTicks) / FGoKartNetClock::TicksPerSecond;
+		float Alpha = (RenderTime - From.ServerTicks) / DurationTicks;
+		if (ProxyLOD == EGoKartProxyLOD::Near) 
+		{
+			FHermiteCubicSpline Spline = CreateSpline(From, Next, Duration);
+			InterpolateLocation(Spline, Alpha);
+			InterpolateVelocity(Spline, Alpha, Duration);
+			InterpolateRotation(From, Next, Alpha);
+		}
+		else if (ProxyLOD == EGoKartProxyLOD::Mid) 
+		{
+			InterpolateLinear(From, Next, Alpha);
+		}
+		else 
+		{
+			const FGoKartSnapshot& Nearest = Alpha < 0.5f ? From : Next;
+			ClientPoseLocation = Nearest.Location;
+			ClientPoseRotation = Nearest.Rotation;
+		}
+	}
+	// Our interpolation always advances, but the mesh is only moved when it's worth it
+	bHasClientPose = IsClientPoseSignificant(ServerTime);
+	if (bHasClientPose) 
+	{
+		AppliedPoseLocation = ClientPoseLocation;
+		AppliedPoseRotation = ClientPoseRotation;
+		AppliedPoseTime = ServerTime;
+		bAppliedPoseValid = true;
+	}
 }
 
-FHermiteCubicSpline UGoKartReplicationComponent::CreateSpline() 
+// Simulated proxy - every mesh update propagates to our wheels, cameras and everything else attached, so off screen
+// and far away karts are only moved every so often, and karts that haven't moved not at all
+bool UGoKartReplicationComponent::IsClientPoseSignificant(double ServerTime) const
+{
+	// A ServerState has moved our actor and mesh somewhere we didn't put it, put it back whatever tier we're in
+	if (!bAppliedPoseValid) return true;
+	float UpdateInterval = !bProxyRecentlyRendered ? HiddenUpdateInterval : ProxyLOD == EGoKartProxyLOD::Far ? FarLODUpdateInterval : 0;
+	if (ServerTime < AppliedPoseTime + UpdateInterval * FGoKartNetClock::TicksPerSecond) return false;
+	return !ClientPoseLocation.Equals(AppliedPoseLocation, 0.1f) || !ClientPoseRotation.Equals(AppliedPoseRotation, 1e-4f);
+}
+
+// Simulated proxy - move our mesh to the pose worked out by ClientTick, in a single transform update
+void UGoKartReplicationComponent::ApplyClientTick() 
+{
+	if (!bHasClientPose || MeshOffsetRoot == nullptr) return;
+	MeshOffsetRoot->SetWorldLocationAndRotation(ClientPoseLocation, ClientPoseRotation);
+}
+
+FHermiteCubicSpline UGoKartReplicationComponent::CreateSpline(const FGoKartSnapshot& From, const FGoKartSnapshot& To, float Duration) 
 {
 	FHermiteCubicSpline Spline;
-	Spline.StartLocation = ClientStartTransform.GetLocation();
-	Spline.TargetLocation = ServerState.Transform.GetLocation();
-	// Derivative = Velocity * TimeBetweenUpdates * (conversion from m [Velocity] to cm [Unreal unit location])
-	float VelocityToDerivative = ClientTimeBetweenUpdates * 100;
-	Spline.StartDerivative = ClientStartVelocity * VelocityToDerivative;
-	Spline.TargetDerivative = ServerState.Velocity * VelocityToDerivative;
+	Spline.StartLocation = From.Location;
+	Spline.TargetLocation = To.Location;
+	// Derivative = Velocity * TimeBetweenSnapshots * (conversion from m [Velocity] to cm [Unreal unit location])
+	float VelocityToDerivative = Duration * 100;
+	Spline.StartDerivative = From.Velocity * VelocityToDerivative;
+	Spline.TargetDerivative = To.Velocity * VelocityToDerivative;
 	return Spline;
 }
 
-// CubicInterp from Start Location/Derivative to the latest ServerState Location/Derivative, over the time between our last 2 updates
+// CubicInterp between two snapshots' Location/Derivative
 void UGoKartReplicationComponent::InterpolateLocation(const FHermiteCubicSpline& Spline, float Alpha) 
 {
-	FVector NewLocation = Spline.InterpolateLocation(Alpha);
-	if (MeshOffsetRoot != nullptr) 
-	{
-		MeshOffsetRoot->SetWorldLocation(NewLocation);
-	}
+	ClientPoseLocation = Spline.InterpolateLocation(Alpha);
 }
 
-void UGoKartReplicationComponent::InterpolateVelocity(const FHermiteCubicSpline& Spline, float Alpha) 
+void UGoKartReplicationComponent::InterpolateVelocity(const FHermiteCubicSpline& Spline, float Alpha, float Duration) 
 {
-	float VelocityToDerivative = ClientTimeBetweenUpdates * 100;
+	float VelocityToDerivative = Duration * 100;
 	// CubicInterpDerivative to get the Derivative at our current Alpha point
 	FVector Derivative = Spline.InterpolateDerivative(Alpha);
-	// Convert to a Velocity (Derivative = Velocity * TimeBetweenUpdates * 100 => Velocity = Derivate / (TimeBetweenUpdates * 100))
+	// Convert to a Velocity (Derivative = Velocity * TimeBetweenSnapshots * 100 => Velocity = Derivate / (TimeBetweenSnapshots * 100))
 	FVector NewVelocity = Derivative / VelocityToDerivative;
 	// Set our Velocity
 	MovementComponent->SetVelocity(NewVelocity);
 }
 
-// Slerp from Start Rotation to the latest ServerState Rotation, over the time between our last 2 updates
-void UGoKartReplicationComponent::InterpolateRotation(float Alpha) 
+// Slerp between two snapshots' Rotation
+void UGoKartReplicationComponent::InterpolateRotation(const FGoKartSnapshot& From, const FGoKartSnapshot& To, float Alpha) 
 {
-	FQuat StartRotation = ClientStartTransform.GetRotation();
-	FQuat TargetRotation = ServerState.Transform.GetRotation();
-	FQuat NewRotation = FQuat::Slerp(StartRotation, TargetRotation, Alpha);
-	if (MeshOffsetRoot != nullptr) 
-	{
-		MeshOffsetRoot->SetWorldRotation(NewRotation);
-	}
+	ClientPoseRotation = FQuat::Slerp(From.Rotation, To.Rotation, Alpha);
+}
+
+// Straight line between two snapshots, for proxies too far away to notice the corners being cut. Our velocity is
+// left at the last ServerState's rather than written every frame.
+void UGoKartReplicationComponent::InterpolateLinear(const FGoKartSnapshot& From, const FGoKartSnapshot& To, float Alpha) 
+{
+	ClientPoseLocation = FMath::Lerp(From.Location, To.Location, Alpha);
+	ClientPoseRotation = FQuat::FastLerp(From.Rotation, To.Rotation, Alpha).GetNormalized();
+}
+
+// Carry on from a snapshot at its velocity, for no longer than MaxExtrapolationTime
+void UGoKartReplicationComponent::Extrapolate(const FGoKartSnapshot& From, float Time) 
+{
+	float ExtrapolationTime = FMath::Clamp(Time, 0.f, MaxExtrapolationTime);
+	ClientPoseLocation = From.Location + From.Velocity * ExtrapolationTime * 100;
+	ClientPoseRotation = From.Rotation;
+	MovementComponent->SetVelocity(From.Velocity);
 }
 
 // Client - handle Server response
@@ -128,61 +374,568 @@ void UGoKartReplicationComponent::OnRep_ServerState()
 void UGoKartReplicationComponent::OnRepServerState_SimulatedProxy() 
 {
 	if (MovementComponent == nullptr) return;
-	if (MeshOffsetRoot != nullptr) 
+	AddSnapshot();
+	GetOwner()->SetActorTransform(ServerState.GetTransform());
+	// Moving our actor moved our mesh with it
+	bAppliedPoseValid = false;
+	// Only the near tier interpolates our velocity, the others keep the latest one
+	MovementComponent->SetVelocity(ServerState.Velocity);
+}
+
+// Simulated proxy - buffer the new ServerState and update our estimate of how far behind the Server to render
+void UGoKartReplicationComponent::AddSnapshot() 
+{
+	// Until our clock is synchronized we can't tell when a snapshot was produced, so the actor just snaps to it
+	const FGoKartNetClock& Clock = GetClock();
+	if (!Clock.IsSynchronized()) return;
+	int64 SnapshotTicks = Clock.UnwrapServerTicks(ServerState.ServerTick);
+	int64 PreviousTicks = Snapshots.IsEmpty() ? 0 : Snapshots.Last().ServerTicks;
+	if (!Snapshots.IsEmpty() && SnapshotTicks <= PreviousTicks) return;
+	Snapshots.Push({ SnapshotTicks, ServerState.Location, ServerState.Rotation.Quat, ServerState.Velocity });
+	// Track how long snapshots take to reach us, and how unevenly they arrive
+	float DelaySample = (Clock.GetServerTime() - SnapshotTicks) / FGoKartNetClock::TicksPerSecond;
+	if (Snapshots.Num() == 1 || ClockGeneration != Clock.GetGeneration()) 
 	{
-		ClientStartTransform = MeshOffsetRoot->GetComponentTransform();
+		ClockGeneration = Clock.GetGeneration();
+		ArrivalDelay = DelaySample;
+		return;
 	}
-	ClientStartVelocity = MovementComponent->GetVelocity();
-	ClientTimeBetweenUpdates = ClientTimeSinceLastUpdate;
-	ClientTimeSinceLastUpdate = 0;
-	GetOwner()->SetActorTransform(ServerState.Transform);
+	float Deviation = DelaySample - ArrivalDelay;
+	ArrivalDelay += Deviation * 0.05f;
+	ArrivalJitter = FMath::Lerp(ArrivalJitter, FMath::Abs(Deviation), 0.1f);
+	SnapshotInterval = FMath::Lerp(SnapshotInterval, static_cast<float>(SnapshotTicks - PreviousTicks) / FGoKartNetClock::TicksPerSecond, 0.1f);
+	InterpolationDelay = FMath::Clamp(SnapshotInterval + JitterDelayMultiplier * ArrivalJitter, MinInterpolationDelay, MaxInterpolationDelay);
 }
 
 void UGoKartReplicationComponent::OnRepServerState_AutonomousProxy() 
 {
 	if (MovementComponent == nullptr) return;
+	SCOPE_CYCLE_COUNTER(STAT_GoKart_Reconcile);
+	CSV_SCOPED_TIMING_STAT(GoKart, Reconcile);
+	if (FGoKartInputTraceWriter* InputTrace = MovementComponent->GetInputTrace()) 
+	{
+		InputTrace->WriteServerState({ ServerState.LastMoveId, ServerState.ServerTick, { ServerState.Location, ServerState.Rotation.Quat, ServerState.Velocity } });
+	}
+	// If the Server ended up where we predicted, every move we made since then was simulated from the right state
+	// and there is nothing to correct
+	int32 AcknowledgedIndex = FindUnacknowledgedMove(ServerState.LastMoveId);
+	// (moves a spread out replay hasn't reached yet have no prediction to compare)
+	bool bPredicted = AcknowledgedIndex != INDEX_NONE && (!IsReplaying() || AcknowledgedIndex < NextReplayIndex);
+	bool bPredictionMatched = bPredicted && PredictionMatchesServerState(UnacknowledgedMoves[AcknowledgedIndex]);
+	// Clear any moves from our queue that have now been acknowledged, the Server obviously received them too
+	ClearAcknowledgedMoves(ServerState.LastMoveId);
+	Client_AcknowledgeMoves_Implementation(ServerState.LastMoveId);
+	if (bPredictionMatched) return;
+	FGoKartNetCounters& Counters = GetNetCounters();
+	Counters.ReplayedMoves += UnacknowledgedMoves.Num();
+	INC_DWORD_STAT_BY(STAT_GoKart_MovesReplayed, UnacknowledgedMoves.Num());
+	CSV_CUSTOM_STAT(GoKart, MovesReplayed, UnacknowledgedMoves.Num(), ECsvCustomStatOp::Accumulate);
+	// Remember where our mesh is drawn, to ease it from there to wherever the replay puts us. If a spread out replay
+	// was still going, this state is just further along than it had got - we carry on from here rather than starting
+	// a new correction, and the moves up to it no longer need replaying at all.
+	if (!IsReplaying()) 
+	{
+		++Counters.Replays;
+		ReplayFrames = 0;
+		CorrectionVisualPose = MeshOffsetRoot != nullptr ? MeshOffsetRoot->GetComponentTransform() : GetOwner()->GetActorTransform();
+		CorrectionVisualVelocity = MovementComponent->GetVelocity() * 100;
+	}
 	// Set our Transform (position/rotation) and Velocity
-	GetOwner()->SetActorTransform(ServerState.Transform);
+	GetOwner()->SetActorTransform(ServerState.GetTransform());
 	MovementComponent->SetVelocity(ServerState.Velocity);
-	// Clear any moves from our queue that have now been acknowledged
-	ClearAcknowledgedMoves(ServerState.LastMove);
-	// Replay/simulate the moves that are still not acknowledged in order to sync up with the Server
-	for (const FGoKartMove& UnacknowledgedMove : UnacknowledgedMoves) 
+	MovementComponent->ResetRenderInterpolation();
+	// Replay/simulate the moves that are still not acknowledged in order to sync up with the Server, all of them now
+	// or the first share of them with the rest to follow in DoTick
+	NextReplayIndex = 0;
+	ReplayMoves(MaxReplayMovesPerFrame);
+}
+
+void UGoKartReplicationComponent::ReplayMoves(int32 MaxMoves) 
+{
+	int32 EndIndex = MaxMoves > 0 ? FMath::Min(NextReplayIndex + MaxMoves, UnacknowledgedMoves.Num()) : UnacknowledgedMoves.Num();
+	for (; NextReplayIndex < EndIndex; ++NextReplayIndex) 
+	{
+		FGoKartPredictedMove& Prediction = UnacknowledgedMoves[NextReplayIndex];
+		MovementComponent->SimulateMove(Prediction.Move, EGoKartCollisionQuery::Cached);
+		// Our old prediction for this move was wrong, keep the corrected one to compare against next time
+		RecordPrediction(Prediction);
+	}
+	if (NextReplayIndex >= UnacknowledgedMoves.Num()) 
+	{
+		FinishReplay();
+	}
+}
+
+// Our actor is back in the present, our mesh starts out where it was drawn and eases onto it
+void UGoKartReplicationComponent::FinishReplay() 
+{
+	NextReplayIndex = INDEX_NONE;
+	MovementComponent->ResetRenderInterpolation();
+	FTransform ActorTransform = GetOwner()->GetActorTransform();
+	VisualErrorLocation = CorrectionVisualPose.GetLocation() - ActorTransform.GetLocation();
+	VisualErrorRotation = CorrectionVisualPose.GetRotation() * ActorTransform.GetRotation().Inverse();
+	bHasVisualError = VisualCorrectionTime > 0 && VisualErrorLocation.SizeSquared() <= FMath::Square(MaxVisualCorrectionDistance);
+	if (!bHasVisualError) 
+	{
+		VisualErrorLocation = FVector::ZeroVector;
+		VisualErrorRotation = FQuat::Identity;
+		// Snap our mesh back onto our actor
+		if (MeshOffsetRoot != nullptr) 
+		{
+			MeshOffsetRoot->SetWorldTransform(ActorTransform);
+		}
+	}
+}
+
+void UGoKartReplicationComponent::SendUnacknowledgedMoves(float DeltaTime) 
+{
+	// Throttle our sends, every send carries all the moves the Server hasn't acknowledged receiving (up to a limit) so
+	// nothing is lost by waiting
+	float SendInterval = 1.f / FMath::Max(InputSendRate, 1.f);
+	ClientTimeSinceLastSend += DeltaTime;
+	if (ClientTimeSinceLastSend < SendInterval) return;
+	// Keep the remainder so we send at InputSendRate on average, but don't build up a burst after a hitch
+	ClientTimeSinceLastSend = FMath::Min(ClientTimeSinceLastSend - SendInterval, SendInterval);
+	// Resend from the oldest move the Server hasn't acknowledged receiving, so a lost batch is covered by the next one.
+	// Moves it has received but not yet simulated stay unacknowledged (we may still need to replay them) but aren't sent.
+	int32 StartIndex = 0;
+	if (ServerReceivedMoveId != 0 && !UnacknowledgedMoves.IsEmpty()) 
+	{
+		StartIndex = FMath::Clamp(FGoKartMove::GetMoveIdDistance(UnacknowledgedMoves.First().Move.MoveId, ServerReceivedMoveId) + 1, 0, UnacknowledgedMoves.Num());
+	}
+	if (StartIndex >= UnacknowledgedMoves.Num()) return;
+	int32 EndIndex = FMath::Min(StartIndex + FMath::Min(RedundantMoveCount, FGoKartMoveBatch::MaxMoves), UnacknowledgedMoves.Num());
+	// Reuse the same batch so its allocation is kept between sends
+	PendingBatch.Moves.Reset();
+	PendingBatch.bStartsAtOldestMove = StartIndex == 0;
+	for (int32 Index = StartIndex; Index < EndIndex; ++Index) 
+	{
+		PendingBatch.Moves.Add(UnacknowledgedMoves[Index].Move);
+	}
+	Server_SendMoves(PendingBatch);
+	++GetNetCounters().MoveRpcsSent;
+}
+
+// Server - tell our client which of its moves have arrived once it has sent us more, or resent ones we already have
+void UGoKartReplicationComponent::SendMoveAck(float DeltaTime) 
+{
+	ServerTimeSinceMoveAck += DeltaTime;
+	if (LastReceivedMoveId == 0 || (LastReceivedMoveId == AcknowledgedMoveId && !bClientResentMoves)) return;
+	if (ServerTimeSinceMoveAck < 1.f / FMath::Max(MoveAckRate, 1.f)) return;
+	ServerTimeSinceMoveAck = 0;
+	AcknowledgedMoveId = LastReceivedMoveId;
+	bClientResentMoves = false;
+	Client_AcknowledgeMoves(LastReceivedMoveId);
+}
+
+// Client - moves up to LastMoveId have reached the Server and needn't be sent again
+void UGoKartReplicationComponent::Client_AcknowledgeMoves_Implementation(uint16 LastMoveId) 
+{
+	if (LastMoveId == 0) return;
+	if (ServerReceivedMoveId == 0 || FGoKartMove::IsNewerMoveId(LastMoveId, ServerReceivedMoveId)) 
 	{
-		MovementComponent->SimulateMove(UnacknowledgedMove);
+		ServerReceivedMoveId = LastMoveId;
 	}
 }
 
+void UGoKartReplicationComponent::SendClockSync(float DeltaTime) 
+{
+	// Ping often until we have a full window of samples, then just often enough to follow clock drift
+	ClientTimeSinceClockSync += DeltaTime;
+	if (ClientTimeSinceClockSync < GetClock().GetRequestInterval()) return;
+	ClientTimeSinceClockSync = 0;
+	Server_RequestClockSync(FGoKartNetClock::GetLocalTicks());
+}
+
+bool UGoKartReplicationComponent::Server_RequestClockSync_Validate(int64 ClientSendTicks) 
+{
+	return true;
+}
+
+// Server - stamp the ping with our clock and send it straight back
+void UGoKartReplicationComponent::Server_RequestClockSync_Implementation(int64 ClientSendTicks) 
+{
+	Client_ReceiveClockSync(ClientSendTicks, GetClock().GetServerTicks());
+}
+
+// Client - our ping came back
+void UGoKartReplicationComponent::Client_ReceiveClockSync_Implementation(int64 ClientSendTicks, int64 ServerTicks) 
+{
+	GetClock().AddSample(ClientSendTicks, ServerTicks, FGoKartNetClock::GetLocalTicks());
+}
+
+FGoKartNetClock& UGoKartReplicationComponent::GetClock() const
+{
+	return GetWorld()->GetSubsystem<UGoKartSimulationSubsystem>()->GetClock();
+}
+
+FGoKartNetCounters& UGoKartReplicationComponent::GetNetCounters() const
+{
+	return GetWorld()->GetSubsystem<UGoKartSimulationSubsystem>()->GetNetCounters();
+}
+
 // Server - Validate a Move command
 bool UGoKartReplicationComponent::Server_Move_Validate(FGoKartMove Move) 
 {
-	float ClientProposedTime = ClientTime + Move.DeltaTime;
-	bool ClientTimeValid = GetWorld()->TimeSeconds > ClientProposedTime; 
-	return ClientTimeValid && Move.IsValid();
+	return Move.IsValid();
 }
 
-// Server - Perform a Move command (extract data for processing in Tick())
+// Server - Queue a Move command, the simulation subsystem simulates it once its turn comes
 void UGoKartReplicationComponent::Server_Move_Implementation(FGoKartMove Move) 
 {
 	if (MovementComponent == nullptr) return;
-	ClientTime += Move.DeltaTime;
-	MovementComponent->SimulateMove(Move);
-	UpdateServerState(Move);
+	SCOPE_CYCLE_COUNTER(STAT_GoKart_ServerReceiveMoves);
+	CSV_SCOPED_TIMING_STAT(GoKart, ServerReceiveMoves);
+	++GetNetCounters().MoveRpcsReceived;
+	EnqueueClientMove(Move);
+	MeasureClientMoveArrival();
 }
 
-void UGoKartReplicationComponent::ClearAcknowledgedMoves(FGoKartMove LastMove) 
+// Server - Validate a batch of moves, ignoring any we've already processed from an earlier batch. Moves that would put
+// the client ahead of our clock are trimmed when they're queued rather than disconnecting it here.
+bool UGoKartReplicationComponent::Server_SendMoves_Validate(const FGoKartMoveBatch& Batch) 
 {
-	UnacknowledgedMoves.RemoveAll([&](const FGoKartMove& Move) {
-		return Move.Timestamp <= LastMove.Timestamp;
-	});
+	for (const FGoKartMove& Move : Batch.Moves) 
+	{
+		if (FGoKartMove::IsNewerMoveId(Move.MoveId, LastReceivedMoveId) && !Move.IsValid()) return false;
+	}
+	return true;
 }
 
-void UGoKartReplicationComponent::UpdateServerState(const FGoKartMove& Move) 
+// Server - how many more ticks of moves the client may send right now. A client can't have spent more time driving
+// than has passed on our clock since its first move arrived, give or take MoveTimeSlack. Both sides count whole ticks,
+// so this holds exactly however long the session has been running - but if that first move was held up in the network
+// we started counting too late, so while the client is ahead of us the start slides earlier at the drift allowance.
+int64 UGoKartReplicationComponent::GetClientMoveTimeBudget() 
+{
+	int64 NowTicks = GetClock().GetServerTicks();
+	ClientMoveDriftTicks = FMath::Min(ClientMoveDriftTicks + (NowTicks - ClientMoveDriftUpdateTicks) * MoveTimeDriftAllowance, static_cast<float>(MoveTimeSlack));
+	ClientMoveDriftUpdateTicks = NowTicks;
+	int64 AheadTicks = ClientMoveTicks - (NowTicks - ClientMoveStartTicks);
+	int64 SlideTicks = FMath::Clamp<int64>(AheadTicks, 0, FMath::FloorToInt(ClientMoveDriftTicks));
+	ClientMoveStartTicks -= SlideTicks;
+	ClientMoveDriftTicks -= SlideTicks;
+	return NowTicks - ClientMoveStartTicks + MoveTimeSlack - ClientMoveTicks;
+}
+
+// Server - Queue the moves in a batch we haven't seen yet, strictly in order. If the batch skips ahead of the last move
+// we have, one in between was lost - we drop the rest rather than leave a hole, and the client's next send (which
+// always starts from the oldest move we haven't acknowledged) fills it in.
+void UGoKartReplicationComponent::Server_SendMoves_Implementation(const FGoKartMoveBatch& Batch) 
 {
-	ServerState.LastMove = Move;
-	if (MeshOffsetRoot != nullptr) 
+	if (MovementComponent == nullptr) return;
+	SCOPE_CYCLE_COUNTER(STAT_GoKart_ServerReceiveMoves);
+	CSV_SCOPED_TIMING_STAT(GoKart, ServerReceiveMoves);
+	++GetNetCounters().MoveRpcsReceived;
+	bool bReceivedNewMove = false;
+	for (int32 Index = 0; Index < Batch.Moves.Num(); ++Index) 
+	{
+		const FGoKartMove& Move = Batch.Moves[Index];
+		if (!FGoKartMove::IsNewerMoveId(Move.MoveId, LastReceivedMoveId)) continue;
+		// ...unless the client no longer has the missing moves to send, then all we can do is carry on from here
+		bool bMissingMovesDropped = Index == 0 && Batch.bStartsAtOldestMove;
+		if (Move.MoveId != FGoKartMove::GetNextMoveId(LastReceivedMoveId) && !bMissingMovesDropped) break;
+		EnqueueClientMove(Move);
+		bReceivedNewMove = true;
+	}
+	bClientResentMoves |= !bReceivedNewMove;
+	if (bReceivedNewMove) 
+	{
+		MeasureClientMoveArrival();
+	}
+}
+
+void UGoKartReplicationComponent::EnqueueClientMove(FGoKartMove Move) 
+{
+	if (!bReceivedClientMove) 
+	{
+		// Count the client's time from when its first move started, not when it finished
+		bReceivedClientMove = true;
+		ClientMoveStartTicks = GetClock().GetServerTicks() - Move.GetDeltaTicks();
+		ClientMoveDriftUpdateTicks = GetClock().GetServerTicks();
+	}
+	// Only simulate as much of a move as the client has time for, its next ServerState will correct it
+	int64 BudgetTicks = GetClientMoveTimeBudget();
+	if (Move.GetDeltaTicks() > BudgetTicks) 
+	{
+		Move.DeltaTime = FGoKartMove::DequantizeDeltaTime(static_cast<uint32>(FMath::Max<int64>(BudgetTicks, 0)));
+		++ClientMovesTrimmed;
+		++GetNetCounters().MovesTrimmed;
+		UE_LOG(LogTemp, Verbose, TEXT("Client move %u is ahead of our clock, trimmed to %.3fs (%d total)"), Move.MoveId, Move.DeltaTime, ClientMovesTrimmed);
+	}
+	ClientMoveTicks += Move.GetDeltaTicks();
+	LastReceivedMoveId = Move.MoveId;
+	// A move that takes no time does nothing, but would still cost us a swept simulation
+	if (Move.GetDeltaTicks() == 0) return;
+	// We drain moves as fast as time passes, so this only fills after a long stall in the network. Dropping the oldest
+	// move desyncs the client until its next ServerState corrects it.
+	if (ClientMoveQueue.IsFull()) 
+	{
+		QueuedClientMoveTicks -= ClientMoveQueue.First().GetDeltaTicks();
+		++ClientMoveQueueOverflows;
+		++GetNetCounters().MoveQueueOverflows;
+		UE_LOG(LogTemp, Warning, TEXT("%s: client move queue full, dropped oldest move (%d total)"), *GetOwner()->GetName(), ClientMoveQueueOverflows);
+	}
+	ClientMoveQueue.Push(Move);
+	QueuedClientMoveTicks += Move.GetDeltaTicks();
+	++GetNetCounters().MovesReceived;
+}
+
+// Server - track how far behind our clock the client's moves arrive, the jitter buffer is sized to how much that varies
+void UGoKartReplicationComponent::MeasureClientMoveArrival() 
+{
+	int64 ElapsedTicks = GetClock().GetServerTicks() - ClientMoveStartTicks;
+	float LagSample = static_cast<float>(ElapsedTicks - ClientMoveTicks) / FGoKartNetClock::TicksPerSecond;
+	float Deviation = LagSample - ClientMoveLag;
+	ClientMoveLag += Deviation * 0.05f;
+	ClientMoveJitter = FMath::Lerp(ClientMoveJitter, FMath::Abs(Deviation), 0.1f);
+}
+
+void UGoKartReplicationComponent::ClearAcknowledgedMoves(uint16 LastMoveId) 
+{
+	if (UnacknowledgedMoves.IsEmpty() || LastMoveId == 0) return;
+	// Our moves have consecutive MoveIds, so the acknowledged move's offset from the oldest tells us how many to drop
+	int32 NumAcknowledged = FMath::Clamp(FGoKartMove::GetMoveIdDistance(UnacknowledgedMoves.First().Move.MoveId, LastMoveId) + 1, 0, UnacknowledgedMoves.Num());
+	UnacknowledgedMoves.PopFront(NumAcknowledged);
+	if (IsReplaying()) 
 	{
-		ServerState.Transform = MeshOffsetRoot->GetComponentTransform();
+		NextReplayIndex = FMath::Max(NextReplayIndex - NumAcknowledged, 0);
 	}
+}
+
+int32 UGoKartReplicationComponent::FindUnacknowledgedMove(uint16 MoveId) const
+{
+	if (UnacknowledgedMoves.IsEmpty() || MoveId == 0) return INDEX_NONE;
+	int32 Index = FGoKartMove::GetMoveIdDistance(UnacknowledgedMoves.First().Move.MoveId, MoveId);
+	return Index >= 0 && Index < UnacknowledgedMoves.Num() ? Index : INDEX_NONE;
+}
+
+bool UGoKartReplicationComponent::PredictionMatchesServerState(const FGoKartPredictedMove& Prediction) const
+{
+	return FVector::DistSquared(Prediction.Location, ServerState.Location) <= FMath::Square(ReconciliationLocationTolerance)
+		&& FVector::DistSquared(Prediction.Velocity, ServerState.Velocity) <= FMath::Square(ReconciliationVelocityTolerance)
+		&& FMath::RadiansToDegrees(Prediction.Rotation.AngularDistance(ServerState.Rotation.Quat)) <= ReconciliationRotationTolerance;
+}
+
+// Store the state our simulation is in right after simulating this move
+void UGoKartReplicationComponent::RecordPrediction(FGoKartPredictedMove& Prediction) const
+{
+	Prediction.Location = GetOwner()->GetActorLocation();
+	Prediction.Rotation = GetOwner()->GetActorQuat();
+	Prediction.Velocity = MovementComponent->GetVelocity();
+}
+
+void UGoKartReplicationComponent::UpdateServerState(const FGoKartMove& Move) 
+{
+	SCOPE_CYCLE_COUNTER(STAT_GoKart_UpdateServerState);
+	ServerState.LastMoveId = Move.MoveId;
+	// Use the simulated actor rather than our mesh, which may be drawn between fixed steps
+	ServerState.SetTransform(GetOwner()->GetActorTransform());
 	ServerState.Velocity = MovementComponent->GetVelocity();
+	ServerState.ServerTick = static_cast<uint32>(GetClock().GetServerTicks());
+	if (CVarCompareStateBandwidth.GetValueOnGameThread() != 0) 
+	{
+		CompareServerStateBandwidth();
+	}
+}
+
+// Server - remember where we are this frame, overwriting the oldest sample once the history is full
+void UGoKartReplicationComponent::RecordHistory(int64 ServerTicks) 
+{
+	if (!History.IsEmpty() && History.Last().ServerTicks >= ServerTicks) return;
+	History.Push({ ServerTicks, GetOwner()->GetActorLocation(), GetOwner()->GetActorQuat(), MovementComponent->GetVelocity() });
+}
+
+// Server - our state at ServerTicks, interpolated between the samples either side of it. Times before our oldest
+// sample or after our newest are clamped to them.
+bool UGoKartReplicationComponent::GetHistoryAt(int64 ServerTicks, FGoKartHistorySample& OutSample) const
+{
+	if (History.IsEmpty()) return false;
+	if (ServerTicks <= History.First().ServerTicks) 
+	{
+		OutSample = History.First();
+		return true;
+	}
+	if (ServerTicks >= History.Last().ServerTicks) 
+	{
+		OutSample = History.Last();
+		return true;
+	}
+	// Samples are in time order, find the first one after ServerTicks
+	int32 Low = 1;
+	int32 High = History.Num() - 1;
+	while (Low < High) 
+	{
+		int32 Middle = (Low + High) / 2;
+		if (History[Middle].ServerTicks <= ServerTicks) 
+		{
+			Low = Middle + 1;
+		}
+		else 
+		{
+			High = Middle;
+		}
+	}
+	const FGoKartHistorySample& From = History[Low - 1];
+	const FGoKartHistorySample& To = History[Low];
+	float Alpha = static_cast<float>(ServerTicks - From.ServerTicks) / (To.ServerTicks - From.ServerTicks);
+	OutSample.ServerTicks = ServerTicks;
+	OutSample.Location = FMath::Lerp(From.Location, To.Location, Alpha);
+	OutSample.Rotation = FQuat::Slerp(From.Rotation, To.Rotation, Alpha);
+	OutSample.Velocity = FMath::Lerp(From.Velocity, To.Velocity, Alpha);
+	return true;
+}
+
+// Server - teleport to where we were at ServerTicks so collision queries see us there, until Restore
+void UGoKartReplicationComponent::Rewind(int64 ServerTicks) 
+{
+	FGoKartHistorySample Sample;
+	if (bRewound || !GetHistoryAt(ServerTicks, Sample)) return;
+	RewindRestoreTransform = GetOwner()->GetActorTransform();
+	bRewound = true;
+	GetOwner()->SetActorLocationAndRotation(Sample.Location, Sample.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+}
+
+void UGoKartReplicationComponent::Restore() 
+{
+	if (!bRewound) return;
+	bRewound = false;
+	GetOwner()->SetActorLocationAndRotation(RewindRestoreTransform.GetLocation(), RewindRestoreTransform.GetRotation(), false, nullptr, ETeleportType::TeleportPhysics);
+}
+
+// Server - Estimate the size of this state in both the old full precision layout and the new compact layout (changed
+// fields only). Only an estimate: we diff against our previous state rather than the one each connection last
+// acknowledged, and take every replicated property's handle to cost a byte.
+void UGoKartReplicationComponent::CompareServerStateBandwidth() 
+{
+	static constexpr int32 HandleBits = 8;
+
+	// Old layout: a full FTransform, an FVector velocity and the echoed FGoKartMove as four floats, each a property
+	FBitWriter FullWriter(2048, true);
+	FTransform Transform = ServerState.GetTransform();
+	FVector Velocity = ServerState.Velocity;
+	float MoveFields[4] = {};
+	FullWriter << Transform << Velocity;
+	FullWriter.Serialize(MoveFields, sizeof(MoveFields));
+	int32 FullHandles = 3;
+
+	// New layout: only the quantized fields that differ from the previous state
+	FBitWriter CompactWriter(2048, true);
+	int32 CompactHandles = 0;
+	bool bSuccess = true;
+	if (ServerState.LastMoveId != BandwidthCompareLastState.LastMoveId) 
+	{
+		CompactWriter << ServerState.LastMoveId;
+		++CompactHandles;
+	}
+	if (ServerState.Location != BandwidthCompareLastState.Location) 
+	{
+		ServerState.Location.NetSerialize(CompactWriter, nullptr, bSuccess);
+		++CompactHandles;
+	}
+	if (!ServerState.Rotation.Quat.Equals(BandwidthCompareLastState.Rotation.Quat, 0)) 
+	{
+		ServerState.Rotation.NetSerialize(CompactWriter, nullptr, bSuccess);
+		++CompactHandles;
+	}
+	if (ServerState.Velocity != BandwidthCompareLastState.Velocity) 
+	{
+		ServerState.Velocity.NetSerialize(CompactWriter, nullptr, bSuccess);
+		++CompactHandles;
+	}
+	if (ServerState.ServerTick != BandwidthCompareLastState.ServerTick) 
+	{
+		CompactWriter << ServerState.ServerTick;
+		++CompactHandles;
+	}
+	BandwidthCompareLastState = ServerState;
+
+	// Both are followed by a terminating handle
+	++BandwidthCompareStates;
+	BandwidthCompareFullBits += FullWriter.GetNumBits() + (FullHandles + 1) * HandleBits;
+	BandwidthCompareCompactBits += CompactWriter.GetNumBits() + (CompactHandles + 1) * HandleBits;
+	double Now = FPlatformTime::Seconds();
+	if (Now - BandwidthCompareReportTime > 5) 
+	{
+		UE_LOG(LogTemp, Log, TEXT("%s ServerState bandwidth estimate over %lld updates: full precision %.1f bytes/update, compact %.1f bytes/update"),
+			*GetOwner()->GetName(), BandwidthCompareStates, BandwidthCompareFullBits / (8.0 * BandwidthCompareStates), BandwidthCompareCompactBits / (8.0 * BandwidthCompareStates));
+		BandwidthCompareReportTime = Now;
+	}
+}
+
+bool FGoKartMoveBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) 
+{
+	uint32 NumMoves = Moves.Num();
+	Ar.SerializeInt(NumMoves, MaxMoves + 1);
+	uint8 bStartsAtOldest = bStartsAtOldestMove;
+	Ar.SerializeBits(&bStartsAtOldest, 1);
+	bStartsAtOldestMove = bStartsAtOldest != 0;
+	if (Ar.IsLoading()) 
+	{
+		Moves.SetNum(NumMoves);
+	}
+	// Moves are consecutive, so only the first carries a MoveId and runs of identical input cost a single bit each
+	for (uint32 Index = 0; Index < NumMoves; ++Index) 
+	{
+		FGoKartMove& Move = Moves[Index];
+		if (Index == 0) 
+		{
+			Move.NetSerialize(Ar, Map, bOutSuccess);
+			continue;
+		}
+		const FGoKartMove& PreviousMove = Moves[Index - 1];
+		uint32 PackedThrottle = 0;
+		uint32 PackedSteeringThrow = 0;
+		uint32 PackedDeltaTime = 0;
+		uint8 bRepeat = 0;
+		if (Ar.IsSaving()) 
+		{
+			PackedThrottle = FGoKartMove::QuantizeAxis(Move.Throttle);
+			PackedSteeringThrow = FGoKartMove::QuantizeAxis(Move.SteeringThrow);
+			PackedDeltaTime = FGoKartMove::QuantizeDeltaTime(Move.DeltaTime);
+			bRepeat = PackedThrottle == FGoKartMove::QuantizeAxis(PreviousMove.Throttle) 
+				&& PackedSteeringThrow == FGoKartMove::QuantizeAxis(PreviousMove.SteeringThrow) 
+				&& PackedDeltaTime == FGoKartMove::QuantizeDeltaTime(PreviousMove.DeltaTime);
+		}
+		Ar.SerializeBits(&bRepeat, 1);
+		if (!bRepeat) 
+		{
+			Ar.SerializeInt(PackedThrottle, FGoKartMove::AxisMax);
+			Ar.SerializeInt(PackedSteeringThrow, FGoKartMove::AxisMax);
+			Ar.SerializeInt(PackedDeltaTime, FGoKartMove::DeltaTimeMax);
+		}
+		if (Ar.IsLoading()) 
+		{
+			Move.Throttle = bRepeat ? PreviousMove.Throttle : FGoKartMove::DequantizeAxis(PackedThrottle);
+			Move.SteeringThrow = bRepeat ? PreviousMove.SteeringThrow : FGoKartMove::DequantizeAxis(PackedSteeringThrow);
+			Move.DeltaTime = bRepeat ? PreviousMove.DeltaTime : FGoKartMove::DequantizeDeltaTime(PackedDeltaTime);
+			Move.MoveId = FGoKartMove::GetNextMoveId(PreviousMove.MoveId);
+		}
+	}
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+bool FGoKartNetRotation::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) 
+{
+	FRotator Rotator = Ar.IsSaving() ? Quat.Rotator() : FRotator::ZeroRotator;
+	uint16 Yaw = FRotator::CompressAxisToShort(Rotator.Yaw);
+	uint16 Pitch = FRotator::CompressAxisToShort(Rotator.Pitch);
+	uint16 Roll = FRotator::CompressAxisToShort(Rotator.Roll);
+	// Level karts only need their yaw, 17 bits instead of a 128 bit quaternion
+	uint8 bTilted = Pitch != 0 || Roll != 0;
+	Ar << Yaw;
+	Ar.SerializeBits(&bTilted, 1);
+	if (bTilted) 
+	{
+		Ar << Pitch;
+		Ar << Roll;
+	}
+	if (Ar.IsLoading()) 
+	{
+		Rotator = FRotator(FRotator::DecompressAxisFromShort(Pitch), FRotator::DecompressAxisFromShort(Yaw), FRotator::DecompressAxisFromShort(Roll));
+		Quat = Rotator.Quaternion();
+	}
+	bOutSuccess = !Ar.IsError();
+	return true;
 }
\ No newline at end of file
@@ -2,19 +2,136 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Engine/NetSerialization.h"
 #include "KrazyKarts/Components/GoKartMovementComponent.h"
+#include "KrazyKarts/Containers/GoKartRingBuffer.h"
+#include "KrazyKarts/Simulation/GoKartNetClock.h"
 #include "GoKartReplicationComponent.generated.h"
 
+struct FGoKartNetCounters;
+
+// Rotation of a kart driving on a (mostly) flat track - a 16 bit yaw, plus pitch and roll only when they're not level
+USTRUCT()
+struct FGoKartNetRotation
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	FQuat Quat = FQuat::Identity;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGoKartNetRotation> : public TStructOpsTypeTraitsBase2<FGoKartNetRotation>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+// Every field is quantized and replicated on its own, so the engine only sends the fields that changed since the last
+// state the client acknowledged. Karts are never scaled, so unlike a full FTransform no scale is sent.
 USTRUCT()
 struct FGoKartState
 {
 	GENERATED_USTRUCT_BODY()
 
 	UPROPERTY()
-	FGoKartMove LastMove;	// The move that produced this state
+	uint16 LastMoveId = 0;	// The MoveId of the move that produced this state
+	UPROPERTY()
+	FVector_NetQuantize100 Location;
 	UPROPERTY()
-	FTransform Transform;
+	FGoKartNetRotation Rotation;
+	UPROPERTY()
+	FVector_NetQuantize100 Velocity;
+	UPROPERTY()
+	uint32 ServerTick = 0;	// Server clock tick when this state was produced, wrapping every ~49 days
+
+	FTransform GetTransform() const
+	{
+		return FTransform(Rotation.Quat, Location);
+	}
+
+	void SetTransform(const FTransform& Transform)
+	{
+		Location = Transform.GetLocation();
+		Rotation.Quat = Transform.GetRotation();
+	}
+};
+
+// A run of consecutive moves, sent unreliably and redundantly so any single lost packet is covered by the next one
+USTRUCT()
+struct FGoKartMoveBatch
+{
+	GENERATED_USTRUCT_BODY()
+
 	UPROPERTY()
+	TArray<FGoKartMove> Moves;
+	// The first move is the oldest the client still has, so if the Server is missing any before it they're gone for good
+	// (the client's unacknowledged moves overflowed) rather than in a batch that was lost
+	bool bStartsAtOldestMove = false;
+
+	static constexpr int32 MaxMoves = 64;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGoKartMoveBatch> : public TStructOpsTypeTraitsBase2<FGoKartMoveBatch>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+UENUM()
+enum class EGoKartInputTransport : uint8
+{
+	// One reliable Server_Move RPC per move
+	Reliable,
+	// Unreliable Server_SendMoves RPCs carrying the moves the Server hasn't acknowledged receiving yet
+	UnreliableRedundant
+};
+
+// How much work a simulated proxy puts into smoothing its movement, picked each frame from how close it is to a local
+// player's view
+enum class EGoKartProxyLOD : uint8
+{
+	// Cubic Hermite location, slerped rotation and interpolated velocity
+	Near,
+	// Linear location and rotation
+	Mid,
+	// Snapped to the nearest snapshot, with our mesh only moved a few times a second
+	Far
+};
+
+// A move we've sent to the Server, along with the state our own simulation predicted it would produce
+struct FGoKartPredictedMove
+{
+	FGoKartMove Move;
+	FVector Location;
+	FQuat Rotation;
+	FVector Velocity;
+};
+
+// A ServerState received by a simulated proxy, kept so we can interpolate between states at a delay
+struct FGoKartSnapshot
+{
+	int64 ServerTicks;
+	FVector Location;
+	FQuat Rotation;
+	FVector Velocity;
+};
+
+// Server - where a kart was at a point in Server time, kept for lag compensation
+struct FGoKartHistorySample
+{
+	int64 ServerTicks;
+	FVector Location;
+	FQuat Rotation;
 	FVector Velocity;
 };
 
@@ -39,28 +156,210 @@ class KRAZYKARTS_API UGoKartReplicationComponent : public UActorComponent
 public:	
 	UFUNCTION(Server, Reliable, WithValidation)
 	void Server_Move(FGoKartMove Move);
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void Server_SendMoves(const FGoKartMoveBatch& Batch);
+	// Clock sync ping, answered with the Server's clock so the client can estimate round trip time and clock offset
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void Server_RequestClockSync(int64 ClientSendTicks);
+	UFUNCTION(Client, Unreliable)
+	void Client_ReceiveClockSync(int64 ClientSendTicks, int64 ServerTicks);
+	// The newest of the client's moves the Server has received, sent far more often than our ServerState so the client
+	// stops resending them
+	UFUNCTION(Client, Unreliable)
+	void Client_AcknowledgeMoves(uint16 LastMoveId);
 	
 	UGoKartReplicationComponent();
+	// Record and send (client) or publish (Server) a move the simulation subsystem just simulated
+	void OnMoveSimulated(const FGoKartMove& Move);
+	// Server - hand this frame's share of our client's queued moves to the Movement Component
+	void DequeueClientMoves(float DeltaTime);
+	// Autonomous proxy - while a correction's replay is spread over frames, queue this frame's new moves behind it
+	// instead of letting the Movement Component simulate them now
+	void DeferMovesWhileReplaying();
+	// Send our batched moves, publish our ServerState and place our mesh, simulated proxies are ticked separately
 	void DoTick(float DeltaTime);
 
 protected:
 	virtual void BeginPlay() override;
 
 private:
+	friend class UGoKartSimulationSubsystem;
+
 	UPROPERTY(ReplicatedUsing=OnRep_ServerState)	
 	FGoKartState ServerState;
 	UPROPERTY()
 	UGoKartMovementComponent* MovementComponent;
 	UPROPERTY()
 	USceneComponent* MeshOffsetRoot;
+	// How our moves are sent to the Server
+	UPROPERTY(EditAnywhere, Category="Networking")
+	EGoKartInputTransport InputTransport = EGoKartInputTransport::UnreliableRedundant;
+	// How many times per second we send our unacknowledged moves when using the unreliable transport
+	UPROPERTY(EditAnywhere, Category="Networking", meta=(EditCondition="InputTransport==EGoKartInputTransport::UnreliableRedundant", ClampMin="1"))
+	float InputSendRate = 60;
+	// The most moves we send at once, from the oldest the Server hasn't acknowledged receiving. Any after that wait for
+	// a later send, once the Server has acknowledged the ones before them.
+	UPROPERTY(EditAnywhere, Category="Networking", meta=(EditCondition="InputTransport==EGoKartInputTransport::UnreliableRedundant", ClampMin="1", ClampMax="64"))
+	int32 RedundantMoveCount = 32;
+	// Server - how many times per second we tell our client which of its moves have arrived, when using the unreliable
+	// transport
+	UPROPERTY(EditAnywhere, Category="Networking", meta=(EditCondition="InputTransport==EGoKartInputTransport::UnreliableRedundant", ClampMin="1"))
+	float MoveAckRate = 30;
+
+	// Moves sent to the Server but not yet acknowledged. When full the oldest move is dropped - its effect on our
+	// prediction is lost until the next ServerState corrects us, which is preferable to growing without limit. Sized for
+	// a client at up to 500fps with its ServerState at AGoKart's 10Hz minimum, a 200ms round trip and a full jitter
+	// buffer on the Server.
+	static constexpr int32 MaxUnacknowledgedMoves = 256;
+	TGoKartRingBuffer<FGoKartPredictedMove, MaxUnacknowledgedMoves> UnacknowledgedMoves;
+	int32 UnacknowledgedMoveOverflows = 0;
+	FGoKartMoveBatch PendingBatch;
+	// How far the Server's state may be from our prediction for the same move before we snap back and replay
+	UPROPERTY(EditAnywhere, Category="Networking")
+	float ReconciliationLocationTolerance = 1;	// cm
+	UPROPERTY(EditAnywhere, Category="Networking")
+	float ReconciliationVelocityTolerance = 0.05f;	// m/s
+	UPROPERTY(EditAnywhere, Category="Networking")
+	float ReconciliationRotationTolerance = 0.5f;	// degrees
+	// A correction moves our simulation straight to the Server's state, but our mesh eases from where it was drawn to
+	// the corrected pose with this time constant (seconds), 0 snaps it there
+	UPROPERTY(EditAnywhere, Category="Networking|Correction", meta=(ClampMin="0"))
+	float VisualCorrectionTime = 0.1f;
+	// Corrections bigger than this are snapped rather than eased (cm)
+	UPROPERTY(EditAnywhere, Category="Networking|Correction", meta=(ClampMin="0"))
+	float MaxVisualCorrectionDistance = 500;
+	// The most unacknowledged moves replayed per frame after a correction, 0 replays them all at once. While a replay
+	// is spread over frames our new moves wait behind it and our mesh coasts on at the velocity it had.
+	UPROPERTY(EditAnywhere, Category="Networking|Correction", meta=(ClampMin="0"))
+	int32 MaxReplayMovesPerFrame = 0;
+	// A spread out replay always gains on the moves we create meanwhile, and once it has taken this many frames
+	// whatever is left is replayed at once, so it finishes even when ServerStates keep moving it along
+	UPROPERTY(EditAnywhere, Category="Networking|Correction", meta=(ClampMin="1"))
+	int32 MaxSpreadReplayFrames = 4;
+	// On top of how long snapshots take to reach us, simulated proxies render this far behind (seconds), adapting to
+	// how often and how evenly snapshots arrive
+	UPROPERTY(EditAnywhere, Category="Networking")
+	float MinInterpolationDelay = 0.05f;
+	UPROPERTY(EditAnywhere, Category="Networking")
+	float MaxInterpolationDelay = 1.5f;
+	// How many multiples of the measured arrival jitter to buffer for, by simulated proxies on top of the snapshot
+	// interval and by the Server before it starts consuming a client's moves
+	UPROPERTY(EditAnywhere, Category="Networking")
+	float JitterDelayMultiplier = 2;
+	// How far past the newest snapshot we'll extrapolate when snapshots are late (seconds)
+	UPROPERTY(EditAnywhere, Category="Networking")
+	float MaxExtrapolationTime = 0.25f;
+	// Simulated proxies within this distance of a local player's view get the near smoothing tier, within
+	// FarLODDistance the mid tier, and the far tier beyond that or when they haven't been rendered recently (cm)
+	UPROPERTY(EditAnywhere, Category="Networking|LOD")
+	float NearLODDistance = 3000;
+	UPROPERTY(EditAnywhere, Category="Networking|LOD")
+	float FarLODDistance = 15000;
+	// How often the far tier moves a proxy's mesh (seconds)
+	UPROPERTY(EditAnywhere, Category="Networking|LOD", meta=(ClampMin="0"))
+	float FarLODUpdateInterval = 0.1f;
+	// How often a proxy that hasn't been rendered recently moves its mesh (seconds), its actor still follows every
+	// ServerState so its bounds stay up to date
+	UPROPERTY(EditAnywhere, Category="Networking|LOD", meta=(ClampMin="0"))
+	float HiddenUpdateInterval = 0.5f;
+	// How far ahead of the Server's clock a client's moves may add up to before they're trimmed (ms), covering a
+	// burst of moves that were held up in the network
+	UPROPERTY(EditAnywhere, Category="Networking", meta=(ClampMin="0"))
+	int32 MoveTimeSlack = 250;
+	// How much faster than the Server's clock (as a fraction) a client's moves may run for a while without being
+	// trimmed, so a budget started from a late first move still recovers
+	UPROPERTY(EditAnywhere, Category="Networking", meta=(ClampMin="0", ClampMax="1"))
+	float MoveTimeDriftAllowance = 0.05f;
+	// Server - the most of a client's moves we'll simulate in one frame, whatever time they add up to. Enough for a
+	// client at 500fps and a Server at 30Hz with a backlog to catch up on.
+	UPROPERTY(EditAnywhere, Category="Networking", meta=(ClampMin="1"))
+	int32 MaxServerMovesPerFrame = 32;
+	// Server - the most time (seconds) we'll hold a client's moves back to absorb jitter
+	UPROPERTY(EditAnywhere, Category="Networking", meta=(ClampMin="0"))
+	float MaxServerJitterBuffer = 0.1f;
+	// Server - the fraction of a client's backlog (beyond the jitter buffer) caught up on each frame
+	UPROPERTY(EditAnywhere, Category="Networking", meta=(ClampMin="0", ClampMax="1"))
+	float ServerCatchUpRate = 0.1f;
 
-	TArray<FGoKartMove> UnacknowledgedMoves;
-	float ClientTimeSinceLastUpdate = 0;
-	float ClientTimeBetweenUpdates = 0;
-	FTransform ClientStartTransform;
-	FVector ClientStartVelocity;
+	TGoKartRingBuffer<FGoKartSnapshot, 32> Snapshots;
+	// How long after the Server produced them snapshots reach us (seconds, by the synchronized clock), and how much
+	// that varies. Re-measured from scratch whenever the clock's offset steps.
+	int32 ClockGeneration = INDEX_NONE;
+	float ArrivalDelay = 0;
+	float ArrivalJitter = 0;
+	float SnapshotInterval = 0.1f;
+	float InterpolationDelay = 0.1f;
+	EGoKartProxyLOD ProxyLOD = EGoKartProxyLOD::Near;
+	bool bProxyRecentlyRendered = true;
+	// Result of the last ClientTick, applied to MeshOffsetRoot on the game thread by ApplyClientTick when it's
+	// significant enough to be worth the transform update
+	bool bHasClientPose = false;
+	// The pose our mesh was last moved to and when (Server ticks), false once a ServerState has moved our actor (and
+	// so our mesh) since
+	FVector AppliedPoseLocation = FVector::ZeroVector;
+	FQuat AppliedPoseRotation = FQuat::Identity;
+	double AppliedPoseTime = 0;
+	bool bAppliedPoseValid = false;
+	FVector ClientPoseLocation;
+	FQuat ClientPoseRotation;
 	
-	float ClientTime = 0;
+	float ClientTimeSinceLastSend = 0;
+	// Autonomous proxy - the newest of our moves the Server has told us it received, our sends start from the next one
+	uint16 ServerReceivedMoveId = 0;
+	float ClientTimeSinceClockSync = 0;
+	// Autonomous proxy - the next unacknowledged move to replay while a replay is spread over frames, how many frames
+	// it has been going and how many new moves we queued behind it this frame
+	int32 NextReplayIndex = INDEX_NONE;
+	int32 ReplayFrames = 0;
+	int32 DeferredMoveCount = 0;
+	// Autonomous proxy - where our mesh was drawn when a correction arrived, coasting on at CorrectionVisualVelocity
+	// (cm/s) until the replay has caught up
+	FTransform CorrectionVisualPose;
+	FVector CorrectionVisualVelocity = FVector::ZeroVector;
+	// Autonomous proxy - how far our mesh is drawn from our actor after a correction, decaying to nothing
+	FVector VisualErrorLocation = FVector::ZeroVector;
+	FQuat VisualErrorRotation = FQuat::Identity;
+	bool bHasVisualError = false;
+	
+	// Server - the total DeltaTime of every move this client has sent, against when its first move arrived. The start
+	// slides earlier by up to MoveTimeDriftAllowance of the time passed (banked in ClientMoveDriftTicks) while the
+	// client is ahead of us.
+	int64 ClientMoveTicks = 0;
+	int64 ClientMoveStartTicks = 0;
+	int64 ClientMoveDriftUpdateTicks = 0;
+	float ClientMoveDriftTicks = 0;
+	bool bReceivedClientMove = false;
+	int32 ClientMovesTrimmed = 0;
+	uint16 LastReceivedMoveId = 0;
+	// Server - the last MoveId we acknowledged receiving to our client, and whether it has since resent moves we already
+	// have (so missed that acknowledgement)
+	uint16 AcknowledgedMoveId = 0;
+	bool bClientResentMoves = false;
+	float ServerTimeSinceMoveAck = 0;
+	// Server - moves received from our client waiting to be simulated, drained at the rate time passes once enough
+	// have built up to ride out the measured jitter in when they arrive
+	TGoKartRingBuffer<FGoKartMove, 256> ClientMoveQueue;
+	int32 ClientMoveQueueOverflows = 0;
+	int64 QueuedClientMoveTicks = 0;
+	float ClientMoveBudget = 0;
+	bool bClientMovesBuffering = true;
+	// Server - how far the client's moves lag behind our clock when they arrive (seconds), and how much that varies
+	float ClientMoveLag = 0;
+	float ClientMoveJitter = 0;
+	// Server - the last move simulated this frame, published as our ServerState once all of them are done
+	FGoKartMove ServerStateMove;
+	bool bServerStateDirty = false;
+	// Server - one sample per frame for lag compensation, about two seconds at 60fps
+	TGoKartRingBuffer<FGoKartHistorySample, 128> History;
+	// Server - where we really are while rewound by the simulation subsystem
+	FTransform RewindRestoreTransform;
+	bool bRewound = false;
+	// Server - kart.Net.CompareStateBandwidth running totals for this kart
+	FGoKartState BandwidthCompareLastState;
+	int64 BandwidthCompareStates = 0;
+	int64 BandwidthCompareFullBits = 0;
+	int64 BandwidthCompareCompactBits = 0;
+	double BandwidthCompareReportTime = 0;
 	
 	UFUNCTION()
 	void OnRep_ServerState();
@@ -70,14 +369,44 @@ private:
 		MeshOffsetRoot = Val;
 	}
 	
-	void ClientTick(float DeltaTime);
-	FHermiteCubicSpline CreateSpline();
+	void UpdateProxyLOD(TArrayView<const FVector> ViewLocations);
+	void ClientTick(double ServerTime);
+	void ApplyClientTick();
+	bool IsClientPoseSignificant(double ServerTime) const;
+	FHermiteCubicSpline CreateSpline(const FGoKartSnapshot& From, const FGoKartSnapshot& To, float Duration);
 	void InterpolateLocation(const FHermiteCubicSpline& Spline, float Alpha);
-	void InterpolateVelocity(const FHermiteCubicSpline& Spline, float Alpha);
-	void InterpolateRotation(float Alpha);
+	void InterpolateVelocity(const FHermiteCubicSpline& Spline, float Alpha, float Duration);
+	void InterpolateRotation(const FGoKartSnapshot& From, const FGoKartSnapshot& To, float Alpha);
+	void InterpolateLinear(const FGoKartSnapshot& From, const FGoKartSnapshot& To, float Alpha);
+	void Extrapolate(const FGoKartSnapshot& From, float Time);
+	void AddSnapshot();
 	void OnRepServerState_SimulatedProxy();
 	void OnRepServerState_AutonomousProxy();
+	bool IsReplaying() const
+	{
+		return NextReplayIndex != INDEX_NONE;
+	}
+	void ReplayMoves(int32 MaxMoves);
+	void FinishReplay();
+	void AddUnacknowledgedMove(const FGoKartPredictedMove& Prediction);
+	void PlaceLocalMesh(float DeltaTime);
+	void SendUnacknowledgedMoves(float DeltaTime);
+	void SendClockSync(float DeltaTime);
+	void SendMoveAck(float DeltaTime);
+	int64 GetClientMoveTimeBudget();
+	FGoKartNetClock& GetClock() const;
+	FGoKartNetCounters& GetNetCounters() const;
+	void EnqueueClientMove(FGoKartMove Move);
+	void MeasureClientMoveArrival();
 	void UpdateServerState(const FGoKartMove& Move);
-	void ClearAcknowledgedMoves(FGoKartMove LastMove);
+	void CompareServerStateBandwidth();
+	void RecordHistory(int64 ServerTicks);
+	bool GetHistoryAt(int64 ServerTicks, FGoKartHistorySample& OutSample) const;
+	void Rewind(int64 ServerTicks);
+	void Restore();
+	void ClearAcknowledgedMoves(uint16 LastMoveId);
+	int32 FindUnacknowledgedMove(uint16 MoveId) const;
+	bool PredictionMatchesServerState(const FGoKartPredictedMove& Prediction) const;
+	void RecordPrediction(FGoKartPredictedMove& Prediction) const;
 		
 };
\ No newline at end of file
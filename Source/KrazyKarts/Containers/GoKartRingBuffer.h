@@ -0,0 +1,98 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+
+// Fixed capacity FIFO queue that never allocates after construction, Capacity must be a power of two
+template<typename ElementType, uint32 Capacity>
+class TGoKartRingBuffer
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "TGoKartRingBuffer capacity must be a power of two");
+
+public:
+	int32 Num() const
+	{
+		return Count;
+	}
+
+	bool IsEmpty() const
+	{
+		return Count == 0;
+	}
+
+	bool IsFull() const
+	{
+		return Count == static_cast<int32>(Capacity);
+	}
+
+	static constexpr int32 Max()
+	{
+		return static_cast<int32>(Capacity);
+	}
+
+	// Add an element to the back of the queue, overwriting the oldest element when full.
+	// Returns false if an element had to be overwritten.
+	bool Push(const ElementType& Element)
+	{
+		bool bOverflowed = IsFull();
+		if (bOverflowed)
+		{
+			PopFront();
+		}
+		Elements[(Head + Count) & (Capacity - 1)] = Element;
+		++Count;
+		return !bOverflowed;
+	}
+
+	// Remove the given number of elements from the front (oldest end) of the queue
+	void PopFront(int32 NumToPop = 1)
+	{
+		check(NumToPop >= 0 && NumToPop <= Count);
+		Head = (Head + NumToPop) & (Capacity - 1);
+		Count -= NumToPop;
+	}
+
+	void Reset()
+	{
+		Head = 0;
+		Count = 0;
+	}
+
+	// Index 0 is the oldest element, Num() - 1 the newest
+	ElementType& operator[](int32 Index)
+	{
+		check(Index >= 0 && Index < Count);
+		return Elements[(Head + Index) & (Capacity - 1)];
+	}
+
+	const ElementType& operator[](int32 Index) const
+	{
+		check(Index >= 0 && Index < Count);
+		return Elements[(Head + Index) & (Capacity - 1)];
+	}
+
+	ElementType& First()
+	{
+		return (*this)[0];
+	}
+
+	const ElementType& First() const
+	{
+		return (*this)[0];
+	}
+
+	ElementType& Last()
+	{
+		return (*this)[Count - 1];
+	}
+
+	const ElementType& Last() const
+	{
+		return (*this)[Count - 1];
+	}
+
+private:
+	TStaticArray<ElementType, Capacity> Elements;
+	uint32 Head = 0;
+	int32 Count = 0;
+};
@@ -8,7 +8,7 @@ public class KrazyKarts : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "PhysXVehicles", "HeadMountedDisplay" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "PhysXVehicles", "HeadMountedDisplay", "ReplicationGraph", "GoKartKinematics" });
 
 		PublicDefinitions.Add("HMD_MODULE_INCLUDED=1");
 	}
@@ -28,10 +28,6 @@ void AKrazyKartsHud::DrawHUD()
 {
 	Super::DrawHUD();
 
-	// Calculate ratio from 720p
-	const float HUDXRatio = Canvas->SizeX / 1280.f;
-	const float HUDYRatio = Canvas->SizeY / 720.f;
-
 	bool bWantHUD = true;
 #if HMD_MODULE_INCLUDED
 	bWantHUD = !GEngine->IsStereoscopic3D();
@@ -43,20 +39,38 @@ void AKrazyKartsHud::DrawHUD()
 		AKrazyKartsPawn* Vehicle = Cast<AKrazyKartsPawn>(GetOwningPawn());
 		if ((Vehicle != nullptr) && (Vehicle->bInCarCameraActive == false))
 		{
-			FVector2D ScaleVec(HUDYRatio * 1.4f, HUDYRatio * 1.4f);
+			const FIntPoint CanvasSize(Canvas->SizeX, Canvas->SizeY);
+			if ((TextItemsVehicle.Get() != Vehicle) || (TextItemsHUDRevision != Vehicle->GetHUDRevision()) || (TextItemsCanvasSize != CanvasSize) || !SpeedTextItem.IsSet())
+			{
+				UpdateTextItems(Vehicle);
+			}
 
-			// Speed
-			FCanvasTextItem SpeedTextItem(FVector2D(HUDXRatio * 805.f, HUDYRatio * 455), Vehicle->SpeedDisplayString, HUDFont, FLinearColor::White);
-			SpeedTextItem.Scale = ScaleVec;
-			Canvas->DrawItem(SpeedTextItem);
-
-			// Gear
-			FCanvasTextItem GearTextItem(FVector2D(HUDXRatio * 805.f, HUDYRatio * 500.f), Vehicle->GearDisplayString, HUDFont, Vehicle->bInReverseGear == false ? Vehicle->GearDisplayColor : Vehicle->GearDisplayReverseColor);
-			GearTextItem.Scale = ScaleVec;
-			Canvas->DrawItem(GearTextItem);
+			Canvas->DrawItem(SpeedTextItem.GetValue());
+			Canvas->DrawItem(GearTextItem.GetValue());
 		}
 	}
 }
 
+void AKrazyKartsHud::UpdateTextItems(const AKrazyKartsPawn* Vehicle)
+{
+	// Calculate ratio from 720p
+	const float HUDXRatio = Canvas->SizeX / 1280.f;
+	const float HUDYRatio = Canvas->SizeY / 720.f;
+
+	FVector2D ScaleVec(HUDYRatio * 1.4f, HUDYRatio * 1.4f);
+
+	// Speed
+	SpeedTextItem.Emplace(FVector2D(HUDXRatio * 805.f, HUDYRatio * 455), Vehicle->SpeedDisplayString, HUDFont, FLinearColor::White);
+	SpeedTextItem->Scale = ScaleVec;
+
+	// Gear
+	GearTextItem.Emplace(FVector2D(HUDXRatio * 805.f, HUDYRatio * 500.f), Vehicle->GearDisplayString, HUDFont, Vehicle->bInReverseGear == false ? Vehicle->GearDisplayColor : Vehicle->GearDisplayReverseColor);
+	GearTextItem->Scale = ScaleVec;
+
+	TextItemsVehicle = Vehicle;
+	TextItemsHUDRevision = Vehicle->GetHUDRevision();
+	TextItemsCanvasSize = FIntPoint(Canvas->SizeX, Canvas->SizeY);
+}
+
 
 #undef LOCTEXT_NAMESPACE
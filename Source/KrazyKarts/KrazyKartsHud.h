@@ -1,8 +1,11 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 #pragma once
 #include "GameFramework/HUD.h"
+#include "CanvasItem.h"
 #include "KrazyKartsHud.generated.h"
 
+class AKrazyKartsPawn;
+
 
 UCLASS(config = Game)
 class AKrazyKartsHud : public AHUD
@@ -19,4 +22,17 @@ public:
 	// Begin AHUD interface
 	virtual void DrawHUD() override;
 	// End AHUD interface
+
+private:
+	/** Rebuild the cached speed and gear items from the vehicle's HUD strings */
+	void UpdateTextItems(const AKrazyKartsPawn* Vehicle);
+
+	/** Speed and gear items, only rebuilt when the vehicle, its HUD strings or the canvas size change */
+	TOptional<FCanvasTextItem> SpeedTextItem;
+	TOptional<FCanvasTextItem> GearTextItem;
+
+	/** What the cached items were built from */
+	TWeakObjectPtr<const AKrazyKartsPawn> TextItemsVehicle;
+	uint32 TextItemsHUDRevision = 0;
+	FIntPoint TextItemsCanvasSize = FIntPoint::ZeroValue;
 };
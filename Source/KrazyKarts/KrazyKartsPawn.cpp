@@ -122,6 +122,12 @@ AKrazyKartsPawn::AKrazyKartsPawn()
 	GearDisplayColor = FColor(255, 255, 255, 255);
 
 	bInReverseGear = false;
+
+	// Nothing has been displayed yet, so the first UpdateHUDStrings always builds the strings
+	DisplayedKPH = INDEX_NONE;
+	DisplayedGear = MIN_int32;
+	HUDRevision = 0;
+	bInCarHUDDirty = true;
 }
 
 void AKrazyKartsPawn::SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent)
@@ -188,6 +194,8 @@ void AKrazyKartsPawn::EnableIncarView(const bool bState, const bool bForce)
 		
 		InCarSpeed->SetVisibility(bInCarCameraActive);
 		InCarGear->SetVisibility(bInCarCameraActive);
+		// The in car text isn't updated while hidden, so bring it up to date
+		bInCarHUDDirty = true;
 	}
 }
 
@@ -202,8 +210,11 @@ void AKrazyKartsPawn::Tick(float Delta)
 	// Update the strings used in the hud (incar and onscreen)
 	UpdateHUDStrings();
 
-	// Set the string in the incar hud
-	SetupInCarHUD();
+	// Set the string in the incar hud, only when it's visible and has changed
+	if (bInCarHUDDirty && bInCarCameraActive)
+	{
+		SetupInCarHUD();
+	}
 
 	bool bHMDActive = false;
 #if HMD_MODULE_INCLUDED
@@ -251,19 +262,37 @@ void AKrazyKartsPawn::UpdateHUDStrings()
 {
 	float KPH = FMath::Abs(GetVehicleMovement()->GetForwardSpeed()) * 0.036f;
 	int32 KPH_int = FMath::FloorToInt(KPH);
+	// Reverse is always shown as "R", and is a negative gear so it never matches a forward gear
+	int32 Gear = GetVehicleMovement()->GetCurrentGear();
 
-	// Using FText because this is display text that should be localizable
-	SpeedDisplayString = FText::Format(LOCTEXT("SpeedFormat", "{0} km/h"), FText::AsNumber(KPH_int));
-	
-	if (bInReverseGear == true)
+	// Formatting text is expensive, so only do it when what we display has changed
+	if ((KPH_int == DisplayedKPH) && (Gear == DisplayedGear))
 	{
-		GearDisplayString = FText(LOCTEXT("ReverseGear", "R"));
+		return;
 	}
-	else
+
+	if (KPH_int != DisplayedKPH)
+	{
+		// Using FText because this is display text that should be localizable
+		SpeedDisplayString = FText::Format(LOCTEXT("SpeedFormat", "{0} km/h"), FText::AsNumber(KPH_int));
+		DisplayedKPH = KPH_int;
+	}
+
+	if (Gear != DisplayedGear)
 	{
-		int32 Gear = GetVehicleMovement()->GetCurrentGear();
-		GearDisplayString = (Gear == 0) ? LOCTEXT("N", "N") : FText::AsNumber(Gear);
-	}	
+		if (bInReverseGear == true)
+		{
+			GearDisplayString = FText(LOCTEXT("ReverseGear", "R"));
+		}
+		else
+		{
+			GearDisplayString = (Gear == 0) ? LOCTEXT("N", "N") : FText::AsNumber(Gear);
+		}
+		DisplayedGear = Gear;
+	}
+
+	++HUDRevision;
+	bInCarHUDDirty = true;
 }
 
 void AKrazyKartsPawn::SetupInCarHUD()
@@ -283,6 +312,8 @@ void AKrazyKartsPawn::SetupInCarHUD()
 		{
 			InCarGear->SetTextRenderColor(GearDisplayReverseColor);
 		}
+
+		bInCarHUDDirty = false;
 	}
 }
 
@@ -72,6 +72,9 @@ public:
 
 	/** Initial offset of incar camera */
 	FVector InternalCameraOrigin;
+
+	/** Changes whenever the HUD strings or gear color change, so HUDs only rebuild what they draw when it does */
+	uint32 GetHUDRevision() const { return HUDRevision; }
 	// Begin Pawn interface
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
 	// End Pawn interface
@@ -114,9 +117,19 @@ private:
 	 */
 	void EnableIncarView( const bool bState, const bool bForce = false );
 
-	/** Update the gear and speed strings */
+	/** Update the gear and speed strings if the values they show have changed */
 	void UpdateHUDStrings();
 
+	/** The speed (km/h) and gear the HUD strings were last built from */
+	int32 DisplayedKPH;
+	int32 DisplayedGear;
+
+	/** Incremented each time the HUD strings are rebuilt */
+	uint32 HUDRevision;
+
+	/** The in car text renders are out of date with the HUD strings */
+	bool bInCarHUDDirty;
+
 	/* Are we on a 'slippery' surface */
 	bool bIsLowFriction;
 
@@ -0,0 +1,208 @@
+#include "KrazyKarts/Networking/GoKartReplicationGraph.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/PlayerController.h"
+#include "UObject/UObjectIterator.h"
+#include "KrazyKarts/Pawns/GoKart.h"
+
+void UGoKartReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+		if (ActorCDO == nullptr || !ActorCDO->GetIsReplicated()) continue;
+		// Left behind by Blueprint compilation
+		if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_"))) continue;
+		EGoKartClassRepNodeMapping Policy = GetMappingPolicy(ActorCDO);
+		ClassRepNodePolicies.Set(Class, Policy);
+		FClassReplicationInfo ClassInfo;
+		// Karts get their rate per connection, see GetKartReplicationPeriod
+		ClassInfo.ReplicationPeriodFrame = Class->IsChildOf<AGoKart>() ? 1 : GetReplicationPeriodForFrequency(ActorCDO->NetUpdateFrequency);
+		if (Policy != EGoKartClassRepNodeMapping::NotRouted && Policy != EGoKartClassRepNodeMapping::RelevantAllConnections)
+		{
+			ClassInfo.SetCullDistanceSquared(ActorCDO->NetCullDistanceSquared);
+		}
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	}
+}
+
+EGoKartClassRepNodeMapping UGoKartReplicationGraph::GetMappingPolicy(const AActor* Actor) const
+{
+	if (Actor->IsA<AGoKart>()) return EGoKartClassRepNodeMapping::Spatialize_Dynamic;
+	if (Actor->bOnlyRelevantToOwner) return EGoKartClassRepNodeMapping::NotRouted;
+	if (Actor->bAlwaysRelevant || Actor->bNetUseOwnerRelevancy) return EGoKartClassRepNodeMapping::RelevantAllConnections;
+	if (Actor->NetDormancy > DORM_Awake) return EGoKartClassRepNodeMapping::Spatialize_Dormancy;
+	return Actor->IsReplicatingMovement() ? EGoKartClassRepNodeMapping::Spatialize_Dynamic : EGoKartClassRepNodeMapping::Spatialize_Static;
+}
+
+void UGoKartReplicationGraph::InitGlobalGraphNodes()
+{
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = KartGridCellSize;
+	GridNode->SpatialBias = KartGridSpatialBias;
+	AddGlobalGraphNode(GridNode);
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UGoKartReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+	AddConnectionGraphNode(CreateNewNode<UGoKartReplicationGraphNode_AlwaysRelevant_ForConnection>(), RepGraphConnection);
+}
+
+void UGoKartReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	// Classes loaded after InitGlobalActorClassSettings fall back to their nearest known parent, or the actor itself
+	const EGoKartClassRepNodeMapping* ClassPolicy = ClassRepNodePolicies.Get(ActorInfo.Class);
+	EGoKartClassRepNodeMapping Policy = ClassPolicy != nullptr ? *ClassPolicy : GetMappingPolicy(ActorInfo.Actor);
+	switch (Policy)
+	{
+	case EGoKartClassRepNodeMapping::NotRouted:
+		break;
+	case EGoKartClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+	case EGoKartClassRepNodeMapping::Spatialize_Static:
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+		break;
+	case EGoKartClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+	case EGoKartClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+	}
+	if (AGoKart* Kart = Cast<AGoKart>(ActorInfo.Actor))
+	{
+		Karts.Add(Kart);
+	}
+}
+
+void UGoKartReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	const EGoKartClassRepNodeMapping* ClassPolicy = ClassRepNodePolicies.Get(ActorInfo.Class);
+	EGoKartClassRepNodeMapping Policy = ClassPolicy != nullptr ? *ClassPolicy : GetMappingPolicy(ActorInfo.Actor);
+	switch (Policy)
+	{
+	case EGoKartClassRepNodeMapping::NotRouted:
+		break;
+	case EGoKartClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+	case EGoKartClassRepNodeMapping::Spatialize_Static:
+		GridNode->RemoveActor_Static(ActorInfo);
+		break;
+	case EGoKartClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+	case EGoKartClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+	}
+	if (AGoKart* Kart = Cast<AGoKart>(ActorInfo.Actor))
+	{
+		Karts.RemoveSwap(Kart);
+	}
+}
+
+const TMap<FIntPoint, TArray<AGoKart*, TInlineAllocator<4>>>& UGoKartReplicationGraph::GetKartCells(uint32 ReplicationFrameNum)
+{
+	if (bKartCellsBuilt && KartCellsFrameNum == ReplicationFrameNum) return KartCells;
+	bKartCellsBuilt = true;
+	KartCellsFrameNum = ReplicationFrameNum;
+	// Keep the cells we've seen before, and their allocations, the track only covers so many
+	for (auto& Cell : KartCells)
+	{
+		Cell.Value.Reset();
+	}
+	float MaxCullDistanceSquared = 0;
+	for (AGoKart* Kart : Karts)
+	{
+		KartCells.FindOrAdd(GetGridCell(Kart->GetActorLocation())).Add(Kart);
+		MaxCullDistanceSquared = FMath::Max(MaxCullDistanceSquared, Kart->NetCullDistanceSquared);
+	}
+	KartCellReach = FMath::CeilToInt(FMath::Sqrt(MaxCullDistanceSquared) / KartGridCellSize);
+	return KartCells;
+}
+
+FIntPoint UGoKartReplicationGraph::GetGridCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt((Location.X - KartGridSpatialBias.X) / KartGridCellSize), FMath::FloorToInt((Location.Y - KartGridSpatialBias.Y) / KartGridCellSize));
+}
+
+uint32 UGoKartReplicationGraph::GetReplicationPeriodForFrequency(float Frequency) const
+{
+	float ServerTickRate = NetDriver != nullptr ? NetDriver->NetServerMaxTickRate : 30;
+	return FMath::Clamp(FMath::RoundToInt(ServerTickRate / FMath::Max(Frequency, 0.1f)), 1, MAX_uint8);
+}
+
+uint32 UGoKartReplicationGraph::GetKartReplicationPeriod(const AGoKart* Kart, const FNetViewerArray& Viewers) const
+{
+	// Our own kart is sent at whatever rate it has picked for us
+	float Frequency = Kart->NetUpdateFrequency;
+	int32 CellDistance = MAX_int32;
+	FIntPoint KartCell = GetGridCell(Kart->GetActorLocation());
+	for (const FNetViewer& Viewer : Viewers)
+	{
+		if (Viewer.ViewTarget == Kart || (Viewer.InViewer != nullptr && Viewer.InViewer == Kart->GetController()))
+		{
+			return GetReplicationPeriodForFrequency(Kart->GetOwnerServerStateFrequency());
+		}
+		FIntPoint Offset = GetGridCell(Viewer.ViewLocation) - KartCell;
+		CellDistance = FMath::Min(CellDistance, FMath::Max(FMath::Abs(Offset.X), FMath::Abs(Offset.Y)));
+	}
+	if (KartCellUpdateFrequencies.Num() > 0)
+	{
+		Frequency = FMath::Min(Frequency, KartCellUpdateFrequencies[FMath::Min(CellDistance, KartCellUpdateFrequencies.Num() - 1)]);
+	}
+	return GetReplicationPeriodForFrequency(Frequency);
+}
+
+void UGoKartReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	UGoKartReplicationGraph* Graph = CastChecked<UGoKartReplicationGraph>(GetOuter());
+	FPerConnectionActorInfoMap& ActorInfoMap = Params.ConnectionManager.ActorInfoMap;
+	// Our PlayerController and the kart it's driving are always relevant to us, wherever they are
+	ReplicationActorList.Reset();
+	for (const FNetViewer& Viewer : Params.Viewers)
+	{
+		ReplicationActorList.ConditionalAdd(Viewer.InViewer);
+		if (Viewer.ViewTarget != nullptr && !ReplicationActorList.Contains(Viewer.ViewTarget))
+		{
+			ReplicationActorList.Add(Viewer.ViewTarget);
+		}
+		APlayerController* PlayerController = Cast<APlayerController>(Viewer.InViewer);
+		APawn* Pawn = PlayerController != nullptr ? PlayerController->GetPawn() : nullptr;
+		if (Pawn != nullptr && !ReplicationActorList.Contains(Pawn))
+		{
+			ReplicationActorList.Add(Pawn);
+		}
+		if (AGoKart* OwnKart = Cast<AGoKart>(Pawn))
+		{
+			ActorInfoMap.FindOrAdd(OwnKart).ReplicationPeriodFrame = Graph->GetKartReplicationPeriod(OwnKart, Params.Viewers);
+		}
+	}
+	Super::GatherActorListsForConnection(Params);
+	// Set how often each kart near enough to be gathered for us is sent to us, before this frame's replication picks
+	// which ones are due. Karts beyond their cull distance aren't gathered for us at all, so are left alone.
+	const TMap<FIntPoint, TArray<AGoKart*, TInlineAllocator<4>>>& KartCells = Graph->GetKartCells(Params.ReplicationFrameNum);
+	int32 Reach = Graph->GetKartCellReach();
+	for (const FNetViewer& Viewer : Params.Viewers)
+	{
+		FIntPoint ViewerCell = Graph->GetGridCell(Viewer.ViewLocation);
+		for (int32 Y = -Reach; Y <= Reach; ++Y)
+		{
+			for (int32 X = -Reach; X <= Reach; ++X)
+			{
+				const TArray<AGoKart*, TInlineAllocator<4>>* CellKarts = KartCells.Find(ViewerCell + FIntPoint(X, Y));
+				if (CellKarts == nullptr) continue;
+				for (AGoKart* Kart : *CellKarts)
+				{
+					ActorInfoMap.FindOrAdd(Kart).ReplicationPeriodFrame = Graph->GetKartReplicationPeriod(Kart, Params.Viewers);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "GoKartReplicationGraph.generated.h"
+
+class AGoKart;
+
+enum class EGoKartClassRepNodeMapping : uint8
+{
+	// Only relevant to their owner, gathered by each connection's UGoKartReplicationGraphNode_AlwaysRelevant_ForConnection
+	NotRouted,
+	RelevantAllConnections,
+	// Spatialized by the grid, by how (if at all) they move
+	Spatialize_Static,
+	Spatialize_Dynamic,
+	Spatialize_Dormancy
+};
+
+// The Server's replication driver (see ReplicationDriverClassName in DefaultEngine.ini). Rather than every connection
+// considering every actor each frame, karts are bucketed by track position into a 2D grid - each kart listed in every
+// cell its cull distance reaches - and each connection only gathers the cell it's viewing from, so replication prep
+// scales with how many karts are near each player instead of connections x actors. Karts further away (in cells) from
+// a connection's viewer are also sent to it less often.
+UCLASS(Transient, Config=Engine)
+class KRAZYKARTS_API UGoKartReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	// Begin UReplicationGraph interface
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	// End UReplicationGraph interface
+
+	// Every kart by the grid cell it's in, rebuilt once per replication frame
+	const TMap<FIntPoint, TArray<AGoKart*, TInlineAllocator<4>>>& GetKartCells(uint32 ReplicationFrameNum);
+	// How many cells away a kart can be and still be gathered for a viewer, from the karts' cull distances
+	int32 GetKartCellReach() const
+	{
+		return KartCellReach;
+	}
+	FIntPoint GetGridCell(const FVector& Location) const;
+	// How many replication frames apart Kart is sent to a connection viewing from Viewers
+	uint32 GetKartReplicationPeriod(const AGoKart* Kart, const FNetViewerArray& Viewers) const;
+
+private:
+	// Size of a grid cell (cm), and the world XY of the grid's corner - everything on the track should be above it
+	UPROPERTY(Config)
+	float KartGridCellSize = 10000;
+	UPROPERTY(Config)
+	FVector2D KartGridSpatialBias = FVector2D(-100000, -100000);
+	// The most often (Hz) a kart is sent to a connection viewing from the same cell, from the next ring of cells out
+	// and so on, the last entry covering every cell beyond. A kart also never goes faster than its own
+	// NetUpdateFrequency, which drops when it's parked.
+	UPROPERTY(Config)
+	TArray<float> KartCellUpdateFrequencies = { 30, 15, 5 };
+
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode;
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+	UPROPERTY()
+	TArray<AGoKart*> Karts;
+
+	TClassMap<EGoKartClassRepNodeMapping> ClassRepNodePolicies;
+	TMap<FIntPoint, TArray<AGoKart*, TInlineAllocator<4>>> KartCells;
+	uint32 KartCellsFrameNum = 0;
+	bool bKartCellsBuilt = false;
+	int32 KartCellReach = 0;
+
+	EGoKartClassRepNodeMapping GetMappingPolicy(const AActor* Actor) const;
+	uint32 GetReplicationPeriodForFrequency(float Frequency) const;
+};
+
+// Per connection - the connection's PlayerController and its own kart, whatever cell they're in, and the rate each kart
+// near enough to be gathered is sent to this connection at
+UCLASS()
+class KRAZYKARTS_API UGoKartReplicationGraphNode_AlwaysRelevant_ForConnection : public UReplicationGraphNode_AlwaysRelevant_ForConnection
+{
+	GENERATED_BODY()
+
+public:
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+};
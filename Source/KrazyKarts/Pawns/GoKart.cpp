@@ -4,6 +4,7 @@
 #include "Engine/World.h"
 #include "GameFramework/GameStateBase.h"
 #include "Net/UnrealNetwork.h"
+#include "KrazyKarts/Simulation/GoKartSimulationSubsystem.h"
 
 AGoKart::AGoKart()
 {
@@ -20,8 +21,20 @@ void AGoKart::BeginPlay()
 	SetReplicateMovement(false);
 	if (HasAuthority())
 	{
-		NetUpdateFrequency = 1;
+		NetUpdateFrequency = MinServerStateFrequency;
+		MinNetUpdateFrequency = MinServerStateFrequency;
 	}
+	// The simulation subsystem moves and replicates every kart in the world together
+	GetWorld()->GetSubsystem<UGoKartSimulationSubsystem>()->RegisterKart(this);
+}
+
+void AGoKart::EndPlay(const EEndPlayReason::Type EndPlayReason) 
+{
+	if (UGoKartSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UGoKartSimulationSubsystem>()) 
+	{
+		Simulation->UnregisterKart(this);
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
 void AGoKart::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -34,9 +47,11 @@ void AGoKart::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 void AGoKart::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
-	// Tick both of our components
-	MovementComponent->DoTick(DeltaTime);
-	ReplicationComponent->DoTick(DeltaTime);
+	// Our components are ticked by UGoKartSimulationSubsystem
+	if (HasAuthority()) 
+	{
+		UpdateServerStateFrequency(DeltaTime);
+	}
 	// Display our replication Role for testing purposes
 	DrawDebugString(GetWorld(), FVector(0, 0, 100), GetEnumText(GetLocalRole()), this, FColor::White, DeltaTime);
 }
@@ -51,6 +66,27 @@ void AGoKart::MoveRight(float Val)
 	MovementComponent->SetSteeringThrow(Val);
 }
 
+// Server - Send our ServerState more often when we're moving or steering hard
+void AGoKart::UpdateServerStateFrequency(float DeltaTime) 
+{
+	if (DeltaTime <= 0) return;
+	// How fast are we and how hard have we been changing our steering recently
+	float SteeringThrow = MovementComponent->GetLastSimulatedSteeringThrow();
+	float SteeringRate = FMath::Abs(SteeringThrow - LastSteeringThrow) / DeltaTime;
+	LastSteeringThrow = SteeringThrow;
+	SmoothedSteeringRate = FMath::Lerp(SmoothedSteeringRate, SteeringRate, FMath::Min(DeltaTime * 4, 1.f));
+	float SpeedActivity = FMath::Clamp(MovementComponent->GetVelocity().Size() / ActiveSpeed, 0.f, 1.f);
+	float SteeringActivity = FMath::Clamp(SmoothedSteeringRate / ActiveSteeringRate, 0.f, 1.f);
+	Activity = FMath::Max(SpeedActivity, SteeringActivity);
+	NetUpdateFrequency = FMath::Lerp(MinServerStateFrequency, MaxServerStateFrequency, Activity);
+}
+
+float AGoKart::GetOwnerServerStateFrequency() const
+{
+	float Frequency = FMath::Lerp(MinServerStateFrequency, FMath::Min(OwnerServerStateFrequency, MaxServerStateFrequency), Activity);
+	return FMath::Max(Frequency, MinOwnerServerStateFrequency);
+}
+
 FString AGoKart::GetEnumText(ENetRole ActorRole) 
 {
 	switch (ActorRole)
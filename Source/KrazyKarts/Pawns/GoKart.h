@@ -22,11 +22,38 @@ public:
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 	void MoveForward(float Val);
 	void MoveRight(float Val);
+	// Server - how often our own client needs our ServerState (Hz), NetUpdateFrequency is what everyone else may get
+	float GetOwnerServerStateFrequency() const;
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
+	// ServerState update rate bounds (Hz) - a parked kart is sent at the minimum, a fast or hard steering kart at the
+	// maximum. How far away each viewer is is left to UGoKartReplicationGraph, which throttles us per connection.
+	UPROPERTY(EditAnywhere, Category="Networking")
+	float MinServerStateFrequency = 1;
+	UPROPERTY(EditAnywhere, Category="Networking")
+	float MaxServerStateFrequency = 30;
+	// The most our own client needs - it only needs enough updates to stay reconciled
+	UPROPERTY(EditAnywhere, Category="Networking")
+	float OwnerServerStateFrequency = 10;
+	// The least our own client gets, however idle we are. It keeps every move since the last ServerState it had, so
+	// this is what its unacknowledged move buffer is sized for (see UGoKartReplicationComponent::MaxUnacknowledgedMoves).
+	UPROPERTY(EditAnywhere, Category="Networking", meta=(ClampMin="10"))
+	float MinOwnerServerStateFrequency = 10;
+	// Speed (m/s) and rate of steering change (full locks per second) that count as fully active
+	UPROPERTY(EditAnywhere, Category="Networking")
+	float ActiveSpeed = 20;
+	UPROPERTY(EditAnywhere, Category="Networking")
+	float ActiveSteeringRate = 2;
+
+	float SmoothedSteeringRate = 0;
+	float LastSteeringThrow = 0;
+	float Activity = 0;
+
 	FString GetEnumText(ENetRole Role);
+	void UpdateServerStateFrequency(float DeltaTime);
 
 };
@@ -0,0 +1,86 @@
+#include "KrazyKarts/Simulation/GoKartCollisionCache.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+
+void FGoKartCollisionCache::Build(const UPrimitiveComponent* KartPrimitive, float Now) 
+{
+	Invalidate();
+	UWorld* World = KartPrimitive->GetWorld();
+	if (World == nullptr) return;
+	Center = KartPrimitive->GetComponentLocation();
+	Radius = KartPrimitive->Bounds.SphereRadius + Margin;
+	// Find all the static geometry our kart would be blocked by within reach, anything that moves is swept every time
+	TArray<FOverlapResult> Overlaps;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GoKartCollisionCache), false, KartPrimitive->GetOwner());
+	QueryParams.MobilityType = EQueryMobilityType::Static;
+	FCollisionResponseParams ResponseParams(KartPrimitive->GetCollisionResponseToChannels());
+	World->OverlapMultiByChannel(Overlaps, Center, FQuat::Identity, KartPrimitive->GetCollisionObjectType(), FCollisionShape::MakeSphere(Radius), QueryParams, ResponseParams);
+	for (const FOverlapResult& Overlap : Overlaps) 
+	{
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (Component == nullptr || !Overlap.bBlockingHit || Component->Mobility == EComponentMobility::Movable) continue;
+		Primitives.Add({ Component, Component->GetComponentTransform() });
+	}
+	BuildTime = Now;
+	bValid = true;
+}
+
+void FGoKartCollisionCache::Invalidate() 
+{
+	Primitives.Reset();
+	bValid = false;
+}
+
+bool FGoKartCollisionCache::Sweep(const UPrimitiveComponent* KartPrimitive, const FVector& Start, const FVector& End, float Now, FHitResult& OutHit) const
+{
+	if (!bValid || Now - BuildTime > Lifetime) return false;
+	// The whole sweep has to stay inside the area we gathered primitives from
+	float ReachSquared = FMath::Square(Radius - KartPrimitive->Bounds.SphereRadius);
+	if (FVector::DistSquared(Start, Center) > ReachSquared || FVector::DistSquared(End, Center) > ReachSquared) return false;
+	// Static geometry shouldn't move, but a level script could still teleport it somewhere we never looked
+	for (const FCachedPrimitive& Primitive : Primitives) 
+	{
+		if (!Primitive.Component.IsValid() || !Primitive.Component->GetComponentTransform().Equals(Primitive.Transform)) return false;
+	}
+	// Sweep against each cached primitive and keep the earliest blocking hit
+	OutHit = FHitResult(1.f);
+	OutHit.TraceStart = Start;
+	OutHit.TraceEnd = End;
+	FCollisionShape KartShape = KartPrimitive->GetCollisionShape();
+	FQuat KartRotation = KartPrimitive->GetComponentQuat();
+	for (const FCachedPrimitive& Primitive : Primitives) 
+	{
+		FHitResult Hit;
+		if (!Primitive.Component->SweepComponent(Hit, Start, End, KartRotation, KartShape)) continue;
+		// Let the scene depenetrate us
+		if (Hit.bStartPenetrating) return false;
+		if (Hit.Time < OutHit.Time) 
+		{
+			OutHit = Hit;
+			OutHit.bBlockingHit = true;
+		}
+	}
+	// Other karts and anything else that moves only need the scene's dynamic tree
+	FHitResult DynamicHit;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GoKartCollisionCacheDynamic), false, KartPrimitive->GetOwner());
+	QueryParams.MobilityType = EQueryMobilityType::Dynamic;
+	FCollisionResponseParams ResponseParams(KartPrimitive->GetCollisionResponseToChannels());
+	if (KartPrimitive->GetWorld()->SweepSingleByChannel(DynamicHit, Start, End, KartRotation, KartPrimitive->GetCollisionObjectType(), KartShape, QueryParams, ResponseParams)) 
+	{
+		if (DynamicHit.bStartPenetrating) return false;
+		if (DynamicHit.Time < OutHit.Time) 
+		{
+			OutHit = DynamicHit;
+		}
+	}
+	// Stop just short of whatever we hit, the same distance a real sweep pulls back (see PullBackHit in
+	// PrimitiveComponent.cpp), so our next sweep doesn't start out touching it
+	float Distance = FVector::Dist(Start, End);
+	if (OutHit.bBlockingHit && Distance > KINDA_SMALL_NUMBER) 
+	{
+		float DesiredTimeBack = FMath::Clamp(0.1f, 0.1f / Distance, 1.f / Distance) + 0.001f;
+		OutHit.Time = FMath::Clamp(OutHit.Time - DesiredTimeBack, 0.f, 1.f);
+	}
+	OutHit.Location = Start + (End - Start) * OutHit.Time;
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPrimitiveComponent;
+
+// The static blocking primitives around a kart, gathered with a single overlap query. Driven, replayed and Server
+// simulated moves sweep against these directly, and only query the scene for things that move (e.g. other karts), so
+// the track itself isn't searched for again on every move.
+class KRAZYKARTS_API FGoKartCollisionCache
+{
+public:
+	// How far beyond the kart's own bounds the cache reaches (cm)
+	float Margin = 500;
+	// How long before we re-query, so newly spawned geometry is picked up (seconds)
+	float Lifetime = 0.5f;
+
+	// Gather the blocking primitives around the kart's current location
+	void Build(const UPrimitiveComponent* KartPrimitive, float Now);
+	void Invalidate();
+
+	// Sweep the kart's collision shape from Start to End against the cached primitives and the scene's moving ones. Like
+	// a real sweep, a blocking hit is pulled back off the surface and OutHit.Location is where the kart should end up.
+	// Returns false if the cache can't answer - it hasn't been built, has expired, the sweep leaves the cached area, a
+	// cached primitive has moved or we start out penetrating something - in which case the caller must do a real sweep.
+	bool Sweep(const UPrimitiveComponent* KartPrimitive, const FVector& Start, const FVector& End, float Now, FHitResult& OutHit) const;
+
+private:
+	struct FCachedPrimitive
+	{
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		FTransform Transform;
+	};
+
+	TArray<FCachedPrimitive, TInlineAllocator<16>> Primitives;
+	FVector Center = FVector::ZeroVector;
+	float Radius = 0;
+	float BuildTime = 0;
+	bool bValid = false;
+};
@@ -0,0 +1,238 @@
+#include "KrazyKarts/Simulation/GoKartInputTrace.h"
+#include "EngineUtils.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "KrazyKarts/Pawns/GoKart.h"
+
+static void SerializeTraceState(FArchive& Ar, FGoKartTraceState& State)
+{
+	Ar << State.Location << State.Rotation << State.Velocity;
+}
+
+TUniquePtr<FGoKartInputTraceWriter> FGoKartInputTraceWriter::Create(const FString& Name)
+{
+	FString Path = GetTracePath(Name);
+	bool bNewFile = IFileManager::Get().FileSize(*Path) <= 0;
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileWriter(*Path, FILEWRITE_Append));
+	if (!Archive.IsValid()) return nullptr;
+	if (bNewFile)
+	{
+		uint32 FileMagic = Magic;
+		uint16 FileVersion = Version;
+		*Archive << FileMagic << FileVersion;
+	}
+	return TUniquePtr<FGoKartInputTraceWriter>(new FGoKartInputTraceWriter(MoveTemp(Archive), Path));
+}
+
+FString FGoKartInputTraceWriter::GetTracePath(const FString& Name)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("InputTraces"), Name + TEXT(".kartrace"));
+}
+
+FGoKartInputTraceWriter::FGoKartInputTraceWriter(TUniquePtr<FArchive> InArchive, const FString& InPath)
+	: Archive(MoveTemp(InArchive))
+	, Path(InPath)
+{
+}
+
+FGoKartInputTraceWriter::~FGoKartInputTraceWriter()
+{
+	Archive->Close();
+}
+
+void FGoKartInputTraceWriter::WriteStart(const FGoKartTraceState& State)
+{
+	uint8 Record = static_cast<uint8>(EGoKartTraceRecord::Start);
+	FGoKartTraceState StateCopy = State;
+	*Archive << Record;
+	SerializeTraceState(*Archive, StateCopy);
+}
+
+// 7 bytes per move
+void FGoKartInputTraceWriter::WriteMove(const FGoKartMove& Move)
+{
+	uint8 Record = static_cast<uint8>(EGoKartTraceRecord::Move);
+	uint16 MoveId = Move.MoveId;
+	uint8 Throttle = static_cast<uint8>(FGoKartMove::QuantizeAxis(Move.Throttle));
+	uint8 SteeringThrow = static_cast<uint8>(FGoKartMove::QuantizeAxis(Move.SteeringThrow));
+	uint16 DeltaTicks = static_cast<uint16>(Move.GetDeltaTicks());
+	*Archive << Record << MoveId << Throttle << SteeringThrow << DeltaTicks;
+}
+
+void FGoKartInputTraceWriter::WriteServerState(const FGoKartTraceServerState& ServerState)
+{
+	uint8 Record = static_cast<uint8>(EGoKartTraceRecord::ServerState);
+	FGoKartTraceServerState StateCopy = ServerState;
+	*Archive << Record << StateCopy.LastMoveId << StateCopy.ServerTick;
+	SerializeTraceState(*Archive, StateCopy.State);
+}
+
+bool LoadInputTrace(const FString& Name, TArray<FGoKartTraceSession>& OutSessions)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *FGoKartInputTraceWriter::GetTracePath(Name))) return false;
+	FMemoryReader Reader(Bytes);
+	uint32 FileMagic = 0;
+	uint16 FileVersion = 0;
+	Reader << FileMagic << FileVersion;
+	if (FileMagic != FGoKartInputTraceWriter::Magic || FileVersion != FGoKartInputTraceWriter::Version) return false;
+	OutSessions.Reset();
+	while (!Reader.AtEnd() && !Reader.IsError())
+	{
+		uint8 Record = 0;
+		Reader << Record;
+		if (Record == static_cast<uint8>(EGoKartTraceRecord::Start))
+		{
+			SerializeTraceState(Reader, OutSessions.AddDefaulted_GetRef().Start);
+			continue;
+		}
+		// A file written by a recording that crashed before its Start record is unusable
+		if (OutSessions.Num() == 0) return false;
+		FGoKartTraceSession& Session = OutSessions.Last();
+		if (Record == static_cast<uint8>(EGoKartTraceRecord::Move))
+		{
+			uint8 Throttle = 0;
+			uint8 SteeringThrow = 0;
+			uint16 DeltaTicks = 0;
+			FGoKartMove& Move = Session.Moves.AddDefaulted_GetRef();
+			Reader << Move.MoveId << Throttle << SteeringThrow << DeltaTicks;
+			Move.Throttle = FGoKartMove::DequantizeAxis(Throttle);
+			Move.SteeringThrow = FGoKartMove::DequantizeAxis(SteeringThrow);
+			Move.DeltaTime = FGoKartMove::DequantizeDeltaTime(DeltaTicks);
+		}
+		else if (Record == static_cast<uint8>(EGoKartTraceRecord::ServerState))
+		{
+			FGoKartTraceServerState& ServerState = Session.ServerStates.AddDefaulted_GetRef();
+			Reader << ServerState.LastMoveId << ServerState.ServerTick;
+			SerializeTraceState(Reader, ServerState.State);
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return !Reader.IsError();
+}
+
+// The kart a trace is recorded from or played back on - the first one we're in control of
+static AGoKart* FindLocalKart(UWorld* World)
+{
+	for (TActorIterator<AGoKart> It(World); It; ++It)
+	{
+		if (It->IsLocallyControlled())
+		{
+			return *It;
+		}
+	}
+	return nullptr;
+}
+
+static void RecordInputTrace(const TArray<FString>& Args, UWorld* World)
+{
+	AGoKart* Kart = FindLocalKart(World);
+	if (Kart == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("kart.Trace.Record: no locally controlled kart"));
+		return;
+	}
+	FString Name = Args.Num() > 0 ? Args[0] : FDateTime::Now().ToString();
+	Kart->MovementComponent->StartInputTrace(Name);
+}
+
+static void StopInputTrace(const TArray<FString>& Args, UWorld* World)
+{
+	if (AGoKart* Kart = FindLocalKart(World))
+	{
+		Kart->MovementComponent->StopInputTrace();
+	}
+}
+
+// Simulate every recorded move back to back on our local kart, which should be in a world with no Server to correct
+// it (e.g. a standalone -game -nullrhi instance). Reports moves per second, and how far the replayed kart ends up
+// from each ServerState that acknowledged a move in the first pass.
+static void PlayInputTrace(const TArray<FString>& Args, UWorld* World)
+{
+	if (Args.Num() < 1)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Usage: kart.Trace.Play <Name> [Loops]"));
+		return;
+	}
+	TArray<FGoKartTraceSession> Sessions;
+	if (!LoadInputTrace(Args[0], Sessions))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("kart.Trace.Play: couldn't read %s"), *FGoKartInputTraceWriter::GetTracePath(Args[0]));
+		return;
+	}
+	AGoKart* Kart = FindLocalKart(World);
+	if (Kart == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("kart.Trace.Play: no locally controlled kart"));
+		return;
+	}
+	int32 Loops = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 1;
+	UGoKartMovementComponent* MovementComponent = Kart->MovementComponent;
+	// Don't record a trace of our own playback
+	MovementComponent->StopInputTrace();
+	FTransform OriginalTransform = Kart->GetActorTransform();
+	FVector OriginalVelocity = MovementComponent->GetVelocity();
+
+	int64 NumMoves = 0;
+	int32 NumCompared = 0;
+	float MaxLocationError = 0;
+	double TotalLocationError = 0;
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 Loop = 0; Loop < Loops; ++Loop)
+	{
+		for (const FGoKartTraceSession& Session : Sessions)
+		{
+			Kart->SetActorLocationAndRotation(Session.Start.Location, Session.Start.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+			MovementComponent->SetVelocity(Session.Start.Velocity);
+			int32 NextServerState = 0;
+			for (const FGoKartMove& Move : Session.Moves)
+			{
+				// Sweep the way driven moves do, so playback times (and collides) like the moves that were recorded
+				MovementComponent->SimulateMove(Move, EGoKartCollisionQuery::Cached);
+				++NumMoves;
+				if (Loop > 0) continue;
+				// Skip ServerStates for moves before this one, then compare against the one for this move if there is one
+				while (Session.ServerStates.IsValidIndex(NextServerState) && FGoKartMove::IsNewerMoveId(Move.MoveId, Session.ServerStates[NextServerState].LastMoveId))
+				{
+					++NextServerState;
+				}
+				if (Session.ServerStates.IsValidIndex(NextServerState) && Session.ServerStates[NextServerState].LastMoveId == Move.MoveId)
+				{
+					float LocationError = FVector::Dist(Kart->GetActorLocation(), Session.ServerStates[NextServerState].State.Location);
+					MaxLocationError = FMath::Max(MaxLocationError, LocationError);
+					TotalLocationError += LocationError;
+					++NumCompared;
+					++NextServerState;
+				}
+			}
+		}
+	}
+	double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+	Kart->SetActorTransform(OriginalTransform, false, nullptr, ETeleportType::TeleportPhysics);
+	MovementComponent->SetVelocity(OriginalVelocity);
+	MovementComponent->ResetRenderInterpolation();
+	UE_LOG(LogTemp, Display, TEXT("kart.Trace.Play %s: %lld moves in %.3fs (%.0f moves/s), %d ServerStates compared, location error mean %.2fcm max %.2fcm"),
+		*Args[0], NumMoves, Elapsed, NumMoves / FMath::Max(Elapsed, 1e-6), NumCompared, NumCompared > 0 ? TotalLocationError / NumCompared : 0.0, MaxLocationError);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs RecordInputTraceCommand(
+	TEXT("kart.Trace.Record"),
+	TEXT("Record our kart's moves and received ServerStates to Saved/InputTraces/[Name].kartrace."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RecordInputTrace));
+
+static FAutoConsoleCommandWithWorldAndArgs StopInputTraceCommand(
+	TEXT("kart.Trace.Stop"),
+	TEXT("Stop recording our kart's input trace."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StopInputTrace));
+
+static FAutoConsoleCommandWithWorldAndArgs PlayInputTraceCommand(
+	TEXT("kart.Trace.Play"),
+	TEXT("Simulate every move in Saved/InputTraces/<Name>.kartrace on our kart [Loops] times, as fast as possible."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PlayInputTrace));
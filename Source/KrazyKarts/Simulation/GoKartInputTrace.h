@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "KrazyKarts/Components/GoKartMovementComponent.h"
+
+// Compact append-only binary log of one kart's driving - where it started, every move it created and every
+// ServerState it received. "kart.Trace.Play" feeds the moves back through the Movement Component as fast as it can,
+// giving a repeatable workload and a check of movement changes against what the Server decided at the time.
+//
+// A file starts with Magic and Version, followed by records that each start with an EGoKartTraceRecord byte:
+//   Start        Location (3 floats), Rotation (4 floats), Velocity (3 floats) - begins a new session
+//   Move         MoveId (uint16), Throttle and SteeringThrow (packed axes, a byte each), DeltaTime (uint16 ms)
+//   ServerState  LastMoveId (uint16), ServerTick (uint32), Location, Rotation, Velocity
+// Recording again to the same file appends another session.
+enum class EGoKartTraceRecord : uint8
+{
+	Start,
+	Move,
+	ServerState
+};
+
+struct FGoKartTraceState
+{
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector Velocity = FVector::ZeroVector;
+};
+
+struct FGoKartTraceServerState
+{
+	uint16 LastMoveId = 0;
+	uint32 ServerTick = 0;
+	FGoKartTraceState State;
+};
+
+// Everything recorded from one Start record to the next
+struct FGoKartTraceSession
+{
+	FGoKartTraceState Start;
+	TArray<FGoKartMove> Moves;
+	TArray<FGoKartTraceServerState> ServerStates;
+};
+
+class KRAZYKARTS_API FGoKartInputTraceWriter
+{
+public:
+	static constexpr uint32 Magic = 0x4B545243;	// 'KTRC'
+	static constexpr uint16 Version = 1;
+
+	// Opens Saved/InputTraces/<Name>.kartrace for appending, returns null if it can't be written
+	static TUniquePtr<FGoKartInputTraceWriter> Create(const FString& Name);
+	static FString GetTracePath(const FString& Name);
+
+	~FGoKartInputTraceWriter();
+
+	void WriteStart(const FGoKartTraceState& State);
+	void WriteMove(const FGoKartMove& Move);
+	void WriteServerState(const FGoKartTraceServerState& ServerState);
+
+	const FString& GetPath() const
+	{
+		return Path;
+	}
+
+private:
+	FGoKartInputTraceWriter(TUniquePtr<FArchive> InArchive, const FString& InPath);
+
+	TUniquePtr<FArchive> Archive;
+	FString Path;
+};
+
+// Read every session in a trace file, returns false if it isn't one
+KRAZYKARTS_API bool LoadInputTrace(const FString& Name, TArray<FGoKartTraceSession>& OutSessions);
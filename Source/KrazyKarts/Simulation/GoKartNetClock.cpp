@@ -0,0 +1,35 @@
+#include "KrazyKarts/Simulation/GoKartNetClock.h"
+
+int64 FGoKartNetClock::GetLocalTicks()
+{
+	return static_cast<int64>(FPlatformTime::Seconds() * TicksPerSecond);
+}
+
+double FGoKartNetClock::GetServerTime() const
+{
+	return FPlatformTime::Seconds() * TicksPerSecond + Offset;
+}
+
+void FGoKartNetClock::AddSample(int64 ClientSendTicks, int64 ServerTicks, int64 ClientReceiveTicks)
+{
+	int64 RoundTrip = ClientReceiveTicks - ClientSendTicks;
+	if (RoundTrip < 0) return;
+	// Assume the Server stamped the ping half way through its round trip
+	Samples.Push({ RoundTrip, ServerTicks + RoundTrip / 2 - ClientReceiveTicks });
+
+	int32 Best = 0;
+	for (int32 Index = 1; Index < Samples.Num(); ++Index)
+	{
+		if (Samples[Index].RoundTripTicks < Samples[Best].RoundTripTicks)
+		{
+			Best = Index;
+		}
+	}
+	bool bFirstSample = Samples.Num() == 1;
+	if (bFirstSample || FMath::Abs(Samples[Best].Offset - Offset) > GenerationStepTicks)
+	{
+		++Generation;
+	}
+	Offset = Samples[Best].Offset;
+	RoundTripTicks = Samples[Best].RoundTripTicks;
+}
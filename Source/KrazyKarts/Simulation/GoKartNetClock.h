@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "KrazyKarts/Containers/GoKartRingBuffer.h"
+
+// Integer millisecond clock shared by the Server and its clients. Every client estimates how far the Server's clock is
+// ahead of its own from ping round trips, keeping the sample with the shortest round trip since it has the least
+// room for asymmetric delay. On the Server (and before the first sample) the Server clock is simply our own.
+class KRAZYKARTS_API FGoKartNetClock
+{
+public:
+	// One tick per millisecond, the same resolution moves send their DeltaTime at
+	static constexpr int64 TicksPerSecond = 1000;
+
+	// How many recent samples the offset is chosen from, and how often to ask for a new one once we have them all
+	static constexpr int32 SampleWindow = 8;
+	static constexpr float FastRequestInterval = 0.2f;
+	static constexpr float RequestInterval = 2.f;
+
+	static int64 GetLocalTicks();
+
+	int64 GetServerTicks() const
+	{
+		return GetLocalTicks() + Offset;
+	}
+
+	// Fractional Server ticks, for rendering between snapshots more finely than a millisecond
+	double GetServerTime() const;
+
+	// Client - a ping sent at ClientSendTicks came back at ClientReceiveTicks, stamped by the Server at ServerTicks
+	void AddSample(int64 ClientSendTicks, int64 ServerTicks, int64 ClientReceiveTicks);
+
+	bool IsSynchronized() const
+	{
+		return !Samples.IsEmpty();
+	}
+
+	int64 GetRoundTripTicks() const
+	{
+		return RoundTripTicks;
+	}
+
+	// Bumped whenever the offset steps far enough that anything measured against the old one should be re-measured
+	int32 GetGeneration() const
+	{
+		return Generation;
+	}
+
+	float GetRequestInterval() const
+	{
+		return Samples.IsFull() ? RequestInterval : FastRequestInterval;
+	}
+
+	// Widen a 32 bit Server tick (as sent over the network) back to the full clock. Valid for ticks within ~24 days
+	// either side of our estimate of Server now.
+	int64 UnwrapServerTicks(uint32 Ticks) const
+	{
+		int64 Now = GetServerTicks();
+		return Now + static_cast<int32>(Ticks - static_cast<uint32>(Now));
+	}
+
+private:
+	struct FSample
+	{
+		int64 RoundTripTicks;
+		int64 Offset;
+	};
+
+	// The offset may step by this many ticks without invalidating measurements made against the old one
+	static constexpr int64 GenerationStepTicks = 20;
+
+	TGoKartRingBuffer<FSample, SampleWindow> Samples;
+	int64 Offset = 0;
+	int64 RoundTripTicks = 0;
+	int32 Generation = 0;
+};
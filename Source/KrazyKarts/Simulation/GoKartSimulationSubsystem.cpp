@@ -0,0 +1,238 @@
+#include "KrazyKarts/Simulation/GoKartSimulationSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "GameFramework/PlayerController.h"
+#include "KrazyKarts/Components/GoKartMovementComponent.h"
+#include "KrazyKarts/Components/GoKartReplicationComponent.h"
+#include "KrazyKarts/Pawns/GoKart.h"
+#include "KrazyKarts/Simulation/GoKartStats.h"
+
+// Enough karts per task that scheduling overhead doesn't outweigh the SIMD work
+static constexpr int32 KinematicsSlotsPerTask = 64;
+
+// Everything a kart holds besides its engine components - both of our components and their fixed size buffers
+static constexpr SIZE_T KartComponentMemory = sizeof(UGoKartMovementComponent) + sizeof(UGoKartReplicationComponent);
+
+void UGoKartSimulationSubsystem::RegisterKart(AGoKart* Kart) 
+{
+	if (Karts.Contains(Kart)) return;
+	Karts.Add(Kart);
+	INC_DWORD_STAT(STAT_GoKart_Karts);
+	INC_MEMORY_STAT_BY(STAT_GoKart_ComponentMemory, KartComponentMemory);
+}
+
+void UGoKartSimulationSubsystem::UnregisterKart(AGoKart* Kart) 
+{
+	if (Karts.Remove(Kart) == 0) return;
+	DEC_DWORD_STAT(STAT_GoKart_Karts);
+	DEC_MEMORY_STAT_BY(STAT_GoKart_ComponentMemory, KartComponentMemory);
+}
+
+void UGoKartSimulationSubsystem::Tick(float DeltaTime) 
+{
+	SCOPE_CYCLE_COUNTER(STAT_GoKart_SimulationTick);
+	CSV_SCOPED_TIMING_STAT(GoKart, SimulationTick);
+	uint64 StartCycles = FPlatformTime::Cycles64();
+	TickMovement(DeltaTime);
+	TickReplication(DeltaTime);
+	RecordHistory();
+	TickProxyInterpolation(DeltaTime);
+	NetCounters.SimulationCycles += FPlatformTime::Cycles64() - StartCycles;
+	++NetCounters.Frames;
+	// Memory held per kart - our components plus each kart's share of the kinematics batch
+	SIZE_T KinematicsMemory = Kinematics.GetAllocatedSize();
+	SET_MEMORY_STAT(STAT_GoKart_KinematicsMemory, KinematicsMemory);
+	CSV_CUSTOM_STAT(GoKart, KartMemoryKB, (KartComponentMemory + KinematicsMemory / FMath::Max(Karts.Num(), 1)) / 1024.f, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(GoKart, Karts, Karts.Num(), ECsvCustomStatOp::Set);
+}
+
+void UGoKartSimulationSubsystem::TickMovement(float DeltaTime) 
+{
+	// Every kart we're in control of creates its moves for this frame (more than one when using a fixed timestep),
+	// and on the Server every other kart takes its share of the moves its client has sent
+	for (AGoKart* Kart : Karts) 
+	{
+		Kart->MovementComponent->CreateMoves(DeltaTime);
+		Kart->ReplicationComponent->DeferMovesWhileReplaying();
+		Kart->ReplicationComponent->DequeueClientMoves(DeltaTime);
+	}
+	// Simulate every kart's first move together, then every kart's second move and so on
+	for (int32 Pass = 0; ; ++Pass) 
+	{
+		MovingKarts.Reset();
+		PendingMoves.Reset();
+		for (AGoKart* Kart : Karts) 
+		{
+			const auto& KartMoves = Kart->MovementComponent->GetPendingMoves();
+			if (KartMoves.IsValidIndex(Pass)) 
+			{
+				MovingKarts.Add(Kart->MovementComponent);
+				PendingMoves.Add(KartMoves[Pass]);
+			}
+		}
+		if (MovingKarts.Num() == 0) break;
+		SimulateMoves(MovingKarts, PendingMoves);
+		for (int32 Index = 0; Index < MovingKarts.Num(); ++Index) 
+		{
+			MovingKarts[Index]->OnLocalMoveSimulated();
+			CastChecked<AGoKart>(MovingKarts[Index]->GetOwner())->ReplicationComponent->OnMoveSimulated(PendingMoves[Index]);
+		}
+	}
+}
+
+void UGoKartSimulationSubsystem::TickReplication(float DeltaTime) 
+{
+	// RPCs and replicated properties have to be touched on the game thread
+	int32 UnacknowledgedMoves = 0;
+	int32 QueuedClientMoves = 0;
+	for (AGoKart* Kart : Karts) 
+	{
+		UGoKartReplicationComponent* ReplicationComponent = Kart->ReplicationComponent;
+		ReplicationComponent->DoTick(DeltaTime);
+		UnacknowledgedMoves += ReplicationComponent->UnacknowledgedMoves.Num();
+		QueuedClientMoves += ReplicationComponent->ClientMoveQueue.Num();
+	}
+	INC_DWORD_STAT_BY(STAT_GoKart_UnacknowledgedMoves, UnacknowledgedMoves);
+	INC_DWORD_STAT_BY(STAT_GoKart_QueuedClientMoves, QueuedClientMoves);
+	CSV_CUSTOM_STAT(GoKart, UnacknowledgedMoves, UnacknowledgedMoves, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(GoKart, QueuedClientMoves, QueuedClientMoves, ECsvCustomStatOp::Set);
+}
+
+// Server - every kart remembers where it ended up this frame. The history is a fixed size ring, so this never allocates.
+void UGoKartSimulationSubsystem::RecordHistory() 
+{
+	if (GetWorld()->GetNetMode() == NM_Client) return;
+	int64 ServerTicks = Clock.GetServerTicks();
+	for (AGoKart* Kart : Karts) 
+	{
+		Kart->ReplicationComponent->RecordHistory(ServerTicks);
+	}
+}
+
+void UGoKartSimulationSubsystem::RewindKarts(int64 ServerTicks, const AGoKart* Except) 
+{
+	for (AGoKart* Kart : Karts) 
+	{
+		if (Kart != Except) 
+		{
+			Kart->ReplicationComponent->Rewind(ServerTicks);
+		}
+	}
+}
+
+void UGoKartSimulationSubsystem::RestoreKarts() 
+{
+	for (AGoKart* Kart : Karts) 
+	{
+		Kart->ReplicationComponent->Restore();
+	}
+}
+
+bool UGoKartSimulationSubsystem::GetKartStateAt(const AGoKart* Kart, int64 ServerTicks, FGoKartHistorySample& OutSample) const
+{
+	return Kart != nullptr && Kart->ReplicationComponent->GetHistoryAt(ServerTicks, OutSample);
+}
+
+void UGoKartSimulationSubsystem::TickProxyInterpolation(float DeltaTime) 
+{
+	CSV_SCOPED_TIMING_STAT(GoKart, ProxyInterpolation);
+	SimulatedProxies.Reset();
+	for (AGoKart* Kart : Karts) 
+	{
+		if (Kart->GetLocalRole() == ROLE_SimulatedProxy) 
+		{
+			SimulatedProxies.Add(Kart->ReplicationComponent);
+		}
+	}
+	CSV_CUSTOM_STAT(GoKart, SimulatedProxies, SimulatedProxies.Num(), ECsvCustomStatOp::Set);
+	if (SimulatedProxies.Num() == 0) return;
+	// Proxies are smoothed less the further they are from every local player's view (more than one in split screen)
+	ViewLocations.Reset();
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator) 
+	{
+		APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController == nullptr || !PlayerController->IsLocalController()) continue;
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		ViewLocations.Add(ViewLocation);
+	}
+	for (UGoKartReplicationComponent* Proxy : SimulatedProxies) 
+	{
+		Proxy->UpdateProxyLOD(ViewLocations);
+	}
+	// Every proxy renders against the same estimate of Server now, read once for the frame
+	double ServerTime = Clock.GetServerTime();
+	// Each proxy only touches its own interpolation state and kinematics slot, so the math can run in parallel...
+	ParallelFor(SimulatedProxies.Num(), [this, ServerTime](int32 Index) 
+	{
+		SimulatedProxies[Index]->ClientTick(ServerTime);
+	});
+	// ...but moving scene components has to happen back on the game thread, for the proxies that decided it's worth it
+	int32 TransformUpdates = 0;
+	for (UGoKartReplicationComponent* Proxy : SimulatedProxies) 
+	{
+		if (Proxy->bHasClientPose) 
+		{
+			Proxy->ApplyClientTick();
+			++TransformUpdates;
+		}
+	}
+	CSV_CUSTOM_STAT(GoKart, ProxyTransformUpdates, TransformUpdates, ECsvCustomStatOp::Set);
+}
+
+void UGoKartSimulationSubsystem::SimulateMoves(TArrayView<UGoKartMovementComponent* const> Components, TArrayView<const FGoKartMove> Moves) 
+{
+	check(Components.Num() == Moves.Num());
+	SCOPE_CYCLE_COUNTER(STAT_GoKart_SimulateMoves);
+	CSV_SCOPED_TIMING_STAT(GoKart, SimulateMoves);
+	INC_DWORD_STAT_BY(STAT_GoKart_MovesSimulated, Components.Num());
+	CSV_CUSTOM_STAT(GoKart, MovesSimulated, Components.Num(), ECsvCustomStatOp::Accumulate);
+	for (int32 Index = 0; Index < Components.Num(); ++Index) 
+	{
+		Components[Index]->StageMove(Moves[Index]);
+	}
+	IntegrateInParallel(&FGoKartKinematicsBatch::IntegrateForcesInRange);
+	// Collision sweeps have to happen one kart at a time on the game thread, and can stop a kart before it turns. Our own
+	// moves sweep the same way the Server and our replays will, so collisions can't be a source of corrections.
+	for (int32 Index = 0; Index < Components.Num(); ++Index) 
+	{
+		Components[Index]->UpdateLocationViaVelocity(EGoKartCollisionQuery::Cached);
+	}
+	IntegrateInParallel(&FGoKartKinematicsBatch::IntegrateRotationInRange);
+	for (int32 Index = 0; Index < Components.Num(); ++Index) 
+	{
+		Components[Index]->ApplyRotation();
+	}
+	Kinematics.ClearMoves();
+}
+
+void UGoKartSimulationSubsystem::IntegrateInParallel(void (FGoKartKinematicsBatch::*Integrate)(int32, int32)) 
+{
+	int32 Capacity = Kinematics.GetCapacity();
+	int32 NumTasks = FMath::DivideAndRoundUp(Capacity, KinematicsSlotsPerTask);
+	ParallelFor(NumTasks, [this, Integrate, Capacity](int32 Task) 
+	{
+		int32 BeginSlot = Task * KinematicsSlotsPerTask;
+		(Kinematics.*Integrate)(BeginSlot, FMath::Min(BeginSlot + KinematicsSlotsPerTask, Capacity));
+	}, NumTasks <= 1);
+}
+
+bool UGoKartSimulationSubsystem::IsTickable() const
+{
+	return Karts.Num() > 0;
+}
+
+ETickableTickType UGoKartSimulationSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UGoKartSimulationSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UGoKartSimulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGoKartSimulationSubsystem, STATGROUP_Tickables);
+}
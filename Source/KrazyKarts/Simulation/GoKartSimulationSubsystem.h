@@ -0,0 +1,130 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "KrazyKarts/Components/GoKartMovementComponent.h"
+#include "GoKartKinematicsBatch.h"
+#include "KrazyKarts/Simulation/GoKartNetClock.h"
+#include "GoKartSimulationSubsystem.generated.h"
+
+class AGoKart;
+class UGoKartReplicationComponent;
+struct FGoKartHistorySample;
+
+// Running totals of the netcode events in this world, read by the load test to report rates
+struct FGoKartNetCounters
+{
+	// Both - frames the subsystem has ticked and the time spent ticking them
+	int64 Frames = 0;
+	uint64 SimulationCycles = 0;
+	// Client - corrections that needed a replay, the moves replayed for them and the move RPCs we sent
+	int64 Replays = 0;
+	int64 ReplayedMoves = 0;
+	int64 MoveRpcsSent = 0;
+	// Server - move RPCs and new moves from clients, moves trimmed for running ahead of our clock, moves dropped from
+	// full queues and ServerStates published
+	int64 MoveRpcsReceived = 0;
+	int64 MovesReceived = 0;
+	int64 MovesTrimmed = 0;
+	int64 MoveQueueOverflows = 0;
+	int64 ServerStatesPublished = 0;
+};
+
+// Owns every kart in the world and steps them together once per frame, in explicit phases:
+//   1. Movement - locally controlled karts create their moves and the Server takes its clients' queued moves, then
+//      each kart's Nth move is simulated in one batch
+//   2. Replication - clients send their moves, the Server publishes each kart's ServerState once
+//      and records where every kart ended up for lag compensation
+//   3. Proxy interpolation - simulated proxies are smoothed towards their latest ServerState
+// The collision-free work (force integration and proxy interpolation math) is spread across worker threads.
+UCLASS()
+class KRAZYKARTS_API UGoKartSimulationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	void RegisterKart(AGoKart* Kart);
+	void UnregisterKart(AGoKart* Kart);
+
+	FGoKartKinematicsBatch& GetKinematics()
+	{
+		return Kinematics;
+	}
+
+	FGoKartNetClock& GetClock()
+	{
+		return Clock;
+	}
+
+	FGoKartNetCounters& GetNetCounters()
+	{
+		return NetCounters;
+	}
+
+	int32 GetNumKarts() const
+	{
+		return Karts.Num();
+	}
+
+	// Simulate one move for each kart, integrating all of their forces in a single SIMD pass
+	void SimulateMoves(TArrayView<UGoKartMovementComponent* const> Components, TArrayView<const FGoKartMove> Moves);
+
+	// Server - lag compensation. Every kart records where it was each frame, so contacts and hit checks can be
+	// evaluated at the Server time a client actually saw. RewindKarts moves every kart but Except back to where it was
+	// at ServerTicks, until RestoreKarts puts them back - prefer FGoKartScopedRewind so they're never left rewound.
+	void RewindKarts(int64 ServerTicks, const AGoKart* Except = nullptr);
+	void RestoreKarts();
+	bool GetKartStateAt(const AGoKart* Kart, int64 ServerTicks, FGoKartHistorySample& OutSample) const;
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+private:
+	UPROPERTY()
+	TArray<AGoKart*> Karts;
+
+	FGoKartKinematicsBatch Kinematics;
+	// Estimate of the Server's clock, fed by our locally controlled kart's clock sync pings (just our own clock on the Server)
+	FGoKartNetClock Clock;
+	FGoKartNetCounters NetCounters;
+
+	// Per frame scratch lists, kept around so their allocations are reused
+	TArray<UGoKartMovementComponent*> MovingKarts;
+	TArray<FGoKartMove> PendingMoves;
+	TArray<UGoKartReplicationComponent*> SimulatedProxies;
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+
+	void TickMovement(float DeltaTime);
+	void TickReplication(float DeltaTime);
+	void RecordHistory();
+	void TickProxyInterpolation(float DeltaTime);
+	void IntegrateInParallel(void (FGoKartKinematicsBatch::*Integrate)(int32, int32));
+};
+
+// Server - rewinds every kart for as long as it's in scope
+class FGoKartScopedRewind
+{
+public:
+	FGoKartScopedRewind(UGoKartSimulationSubsystem& InSimulation, int64 ServerTicks, const AGoKart* Except = nullptr)
+		: Simulation(InSimulation)
+	{
+		Simulation.RewindKarts(ServerTicks, Except);
+	}
+
+	~FGoKartScopedRewind()
+	{
+		Simulation.RestoreKarts();
+	}
+
+	FGoKartScopedRewind(const FGoKartScopedRewind&) = delete;
+	FGoKartScopedRewind& operator=(const FGoKartScopedRewind&) = delete;
+
+private:
+	UGoKartSimulationSubsystem& Simulation;
+};
@@ -0,0 +1,20 @@
+#include "KrazyKarts/Simulation/GoKartStats.h"
+
+DEFINE_STAT(STAT_GoKart_SimulationTick);
+DEFINE_STAT(STAT_GoKart_SimulateMoves);
+DEFINE_STAT(STAT_GoKart_SimulateMove);
+DEFINE_STAT(STAT_GoKart_Reconcile);
+DEFINE_STAT(STAT_GoKart_ClientTick);
+DEFINE_STAT(STAT_GoKart_ServerReceiveMoves);
+DEFINE_STAT(STAT_GoKart_UpdateServerState);
+
+DEFINE_STAT(STAT_GoKart_MovesSimulated);
+DEFINE_STAT(STAT_GoKart_MovesReplayed);
+DEFINE_STAT(STAT_GoKart_UnacknowledgedMoves);
+DEFINE_STAT(STAT_GoKart_QueuedClientMoves);
+DEFINE_STAT(STAT_GoKart_Karts);
+
+DEFINE_STAT(STAT_GoKart_ComponentMemory);
+DEFINE_STAT(STAT_GoKart_KinematicsMemory);
+
+CSV_DEFINE_CATEGORY(GoKart, true);
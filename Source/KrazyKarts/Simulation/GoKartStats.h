@@ -0,0 +1,28 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+// "stat GoKart" in development builds. The GoKart CSV category carries the same timings and counts into Test builds,
+// where stats are compiled out, e.g. "-csvCategories=GoKart" on a dedicated server's command line.
+DECLARE_STATS_GROUP(TEXT("GoKart"), STATGROUP_GoKart, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Simulation Tick"), STAT_GoKart_SimulationTick, STATGROUP_GoKart, KRAZYKARTS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Simulate Moves (batched)"), STAT_GoKart_SimulateMoves, STATGROUP_GoKart, KRAZYKARTS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Simulate Move"), STAT_GoKart_SimulateMove, STATGROUP_GoKart, KRAZYKARTS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Reconcile Autonomous Proxy"), STAT_GoKart_Reconcile, STATGROUP_GoKart, KRAZYKARTS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Proxy ClientTick"), STAT_GoKart_ClientTick, STATGROUP_GoKart, KRAZYKARTS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Server Receive Moves"), STAT_GoKart_ServerReceiveMoves, STATGROUP_GoKart, KRAZYKARTS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update ServerState"), STAT_GoKart_UpdateServerState, STATGROUP_GoKart, KRAZYKARTS_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Moves Simulated"), STAT_GoKart_MovesSimulated, STATGROUP_GoKart, KRAZYKARTS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Moves Replayed"), STAT_GoKart_MovesReplayed, STATGROUP_GoKart, KRAZYKARTS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Unacknowledged Moves"), STAT_GoKart_UnacknowledgedMoves, STATGROUP_GoKart, KRAZYKARTS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queued Client Moves"), STAT_GoKart_QueuedClientMoves, STATGROUP_GoKart, KRAZYKARTS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Karts"), STAT_GoKart_Karts, STATGROUP_GoKart, KRAZYKARTS_API);
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Kart Components"), STAT_GoKart_ComponentMemory, STATGROUP_GoKart, KRAZYKARTS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Kinematics Batch"), STAT_GoKart_KinematicsMemory, STATGROUP_GoKart, KRAZYKARTS_API);
+
+CSV_DECLARE_CATEGORY_EXTERN(GoKart);
@@ -0,0 +1,30 @@
+#include "KrazyKarts/Simulation/GoKartTuning.h"
+#include "UObject/UObjectIterator.h"
+#include "KrazyKarts/Components/GoKartMovementComponent.h"
+
+const FGoKartKinematicsTuning& UGoKartTuning::GetKinematicsTuning(float GravityAcceleration) const
+{
+	if (GravityAcceleration != KinematicsGravityAcceleration)
+	{
+		KinematicsTuning = FGoKartKinematicsTuning::Make(Mass, MaxDrivingForce, DragCoefficient, RollingResistanceCoefficient, MinTurningRadius, GravityAcceleration);
+		KinematicsTuning.MaxSubsteps = Integrator == EGoKartIntegrator::Substepped ? MaxSubsteps : 1;
+		KinematicsGravityAcceleration = GravityAcceleration;
+	}
+	return KinematicsTuning;
+}
+
+#if WITH_EDITOR
+void UGoKartTuning::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	KinematicsGravityAcceleration = -1;
+	// Hot reload - karts already playing pick up the change on their next move
+	for (TObjectIterator<UGoKartMovementComponent> It; It; ++It)
+	{
+		if (It->GetTuning() == this)
+		{
+			It->RefreshTuning();
+		}
+	}
+}
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "GoKartKinematics.h"
+#include "GoKartTuning.generated.h"
+
+UENUM()
+enum class EGoKartIntegrator : uint8
+{
+	// One explicit Euler step per move, whatever its length
+	Euler,
+	// Split long moves into substeps so drag and braking stay stable and accurate at low frame rates
+	Substepped
+};
+
+// How a kind of kart drives. Every kart using the same asset shares it, so the Server and its clients always simulate
+// with the same numbers, and the values the integrator needs are worked out once per asset rather than per kart.
+// Editing an asset while playing in the editor pushes the new tuning to every kart using it straight away.
+UCLASS(BlueprintType)
+class KRAZYKARTS_API UGoKartTuning : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Mass of car in kg
+	UPROPERTY(EditAnywhere, Category="Tuning", meta=(ClampMin="1"))
+	float Mass = 1000;
+	// The force applied to the car when the throttle is down
+	UPROPERTY(EditAnywhere, Category="Tuning", meta=(ClampMin="0"))
+	float MaxDrivingForce = 10000;
+	// The amount of drag applied to the car when calculating Air Resistance (kg/m)
+	UPROPERTY(EditAnywhere, Category="Tuning", meta=(ClampMin="0"))
+	float DragCoefficient = 16;
+	// The rolling resistance that our tires exert.
+	UPROPERTY(EditAnywhere, Category="Tuning", meta=(ClampMin="0"))
+	float RollingResistanceCoefficient = 0.015f;
+	// The minimum radius of our turning circle at full turn (meters).
+	UPROPERTY(EditAnywhere, Category="Tuning", meta=(ClampMin="0.1"))
+	float MinTurningRadius = 10;
+	UPROPERTY(EditAnywhere, Category="Integration")
+	EGoKartIntegrator Integrator = EGoKartIntegrator::Substepped;
+	// Most substeps one move can take, short moves only ever take one
+	UPROPERTY(EditAnywhere, Category="Integration", meta=(EditCondition="Integrator == EGoKartIntegrator::Substepped", ClampMin="2", ClampMax="32"))
+	int32 MaxSubsteps = 8;
+
+	// The integrator's view of this tuning under GravityAcceleration (m/s^2), only recalculated when that changes
+	const FGoKartKinematicsTuning& GetKinematicsTuning(float GravityAcceleration) const;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	mutable FGoKartKinematicsTuning KinematicsTuning;
+	// Gravity KinematicsTuning was made for, negative when it needs making
+	mutable float KinematicsGravityAcceleration = -1;
+};
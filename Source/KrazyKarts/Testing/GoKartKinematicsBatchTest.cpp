@@ -0,0 +1,175 @@
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "GoKartKinematicsBatch.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// A kart as the Movement Component stored it before the kinematics were split out
+struct FGoKartBaselineKart
+{
+	float Mass = 1000;
+	float MaxDrivingForce = 10000;
+	float DragCoefficient = 16;
+	float RollingResistanceCoefficient = 0.015f;
+	float MinTurningRadius = 10;
+	float GravityAcceleration = 9.81f;
+	FVector Velocity = FVector::ZeroVector;
+};
+
+// The Movement Component's SimulateMove as it was before the kinematics were split out, kept verbatim (bar the
+// collision sweep) as the reference both batch paths have to match for karts that take one step per move. Returns the
+// rotation angle the move turns the kart by.
+static float SimulateBaselineMove(FGoKartBaselineKart& Kart, const FVector& Forward, const FVector& Up, float Throttle, float SteeringThrow, float DeltaTime)
+{
+	// Create our "driving force" by taking our input * driving force * forward
+	FVector Force = Forward * Kart.MaxDrivingForce * Throttle;
+	// Air Resistance = -Speed^2 * DragCoefficient
+	Force += -Kart.Velocity.GetSafeNormal() * Kart.Velocity.SizeSquared() * Kart.DragCoefficient;
+	// RollingResistance = RRCoefficient * NormalForce, F = m * g
+	Force += -Kart.Velocity.GetSafeNormal() * Kart.RollingResistanceCoefficient * Kart.Mass * Kart.GravityAcceleration;
+	// Dv = a * Dt
+	Kart.Velocity += Force / Kart.Mass * DeltaTime;
+	// dX - change in location along our turning circle over time, dTheta = dX / R
+	float DeltaLocation = FVector::DotProduct(Forward, Kart.Velocity) * DeltaTime;
+	float RotationAngleRadians = DeltaLocation / Kart.MinTurningRadius * SteeringThrow;
+	Kart.Velocity = FQuat(Up, RotationAngleRadians).RotateVector(Kart.Velocity);
+	return RotationAngleRadians;
+}
+
+// Run the same random karts through the SIMD and scalar batch paths. Single step karts are checked against the original
+// integration, substepped karts (which deliberately differ from it) against the scalar path.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGoKartKinematicsBatchEquivalenceTest, "KrazyKarts.Kinematics.BatchEquivalence", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FGoKartKinematicsBatchEquivalenceTest::RunTest(const FString& Parameters)
+{
+	// Not a multiple of 4, so the SIMD path has spare lanes
+	const int32 NumKarts = 1023;
+	const int32 NumSteps = 120;
+	FRandomStream Random(1234);
+	FGoKartKinematicsBatch SimdBatch;
+	FGoKartKinematicsBatch ScalarBatch;
+	TArray<int32> Slots;
+	TArray<FGoKartBaselineKart> BaselineKarts;
+	for (int32 Index = 0; Index < NumKarts; ++Index)
+	{
+		FGoKartBaselineKart Kart;
+		Kart.Mass = Random.FRandRange(500, 2000);
+		Kart.MaxDrivingForce = Random.FRandRange(5000, 20000);
+		Kart.DragCoefficient = Random.FRandRange(4, 32);
+		Kart.RollingResistanceCoefficient = Random.FRandRange(0.005f, 0.03f);
+		Kart.MinTurningRadius = Random.FRandRange(5, 20);
+		Kart.Velocity = Random.GetUnitVector() * Random.FRandRange(0, 30);
+		FGoKartKinematicsTuning Tuning = FGoKartKinematicsTuning::Make(Kart.Mass, Kart.MaxDrivingForce, Kart.DragCoefficient, Kart.RollingResistanceCoefficient, Kart.MinTurningRadius, Kart.GravityAcceleration);
+		// Half Euler, half substepped
+		Tuning.MaxSubsteps = Index % 2 == 0 ? 1 : 8;
+		int32 Slot = SimdBatch.AddKart();
+		verify(ScalarBatch.AddKart() == Slot);
+		SimdBatch.SetTuning(Slot, Tuning);
+		ScalarBatch.SetTuning(Slot, Tuning);
+		SimdBatch.SetVelocity(Slot, Kart.Velocity);
+		ScalarBatch.SetVelocity(Slot, Kart.Velocity);
+		Slots.Add(Slot);
+		BaselineKarts.Add(Kart);
+	}
+	auto GetVelocityError = [](const FVector& Velocity, const FVector& Expected)
+	{
+		return (Velocity - Expected).Size() / FMath::Max(1.f, Expected.Size());
+	};
+	auto GetAngleError = [](float Angle, float Expected)
+	{
+		return FMath::Abs(Angle - Expected) / FMath::Max(1.f, FMath::Abs(Expected));
+	};
+	float MaxScalarVelocityError = 0;
+	float MaxScalarAngleError = 0;
+	float MaxSimdVelocityError = 0;
+	float MaxSimdAngleError = 0;
+	for (int32 Step = 0; Step < NumSteps; ++Step)
+	{
+		TArray<float> BaselineAngles;
+		BaselineAngles.SetNumUninitialized(NumKarts);
+		for (int32 Index = 0; Index < NumKarts; ++Index)
+		{
+			FVector Up = FVector(Random.FRandRange(-0.1f, 0.1f), Random.FRandRange(-0.1f, 0.1f), 1).GetSafeNormal();
+			FVector Forward = FVector::VectorPlaneProject(Random.GetUnitVector(), Up).GetSafeNormal();
+			float Throttle = Random.FRandRange(-1, 1);
+			float SteeringThrow = Random.FRandRange(-1, 1);
+			float DeltaTime = Random.FRandRange(0.004f, 0.05f);
+			SimdBatch.SetMove(Slots[Index], Forward, Up, Throttle, SteeringThrow, DeltaTime);
+			ScalarBatch.SetMove(Slots[Index], Forward, Up, Throttle, SteeringThrow, DeltaTime);
+			BaselineAngles[Index] = SimulateBaselineMove(BaselineKarts[Index], Forward, Up, Throttle, SteeringThrow, DeltaTime);
+		}
+		SimdBatch.IntegrateForces();
+		SimdBatch.IntegrateRotation();
+		for (int32 Index = 0; Index < NumKarts; ++Index)
+		{
+			int32 Slot = Slots[Index];
+			ScalarBatch.IntegrateForces(Slot);
+			ScalarBatch.IntegrateRotation(Slot);
+			bool bSubstepped = ScalarBatch.GetTuning(Slot).MaxSubsteps > 1;
+			FVector ExpectedVelocity = bSubstepped ? ScalarBatch.GetVelocity(Slot) : BaselineKarts[Index].Velocity;
+			float ExpectedAngle = bSubstepped ? ScalarBatch.GetRotationAngle(Slot) : BaselineAngles[Index];
+			if (!bSubstepped)
+			{
+				MaxScalarVelocityError = FMath::Max(MaxScalarVelocityError, GetVelocityError(ScalarBatch.GetVelocity(Slot), ExpectedVelocity));
+				MaxScalarAngleError = FMath::Max(MaxScalarAngleError, GetAngleError(ScalarBatch.GetRotationAngle(Slot), ExpectedAngle));
+			}
+			MaxSimdVelocityError = FMath::Max(MaxSimdVelocityError, GetVelocityError(SimdBatch.GetVelocity(Slot), ExpectedVelocity));
+			MaxSimdAngleError = FMath::Max(MaxSimdAngleError, GetAngleError(SimdBatch.GetRotationAngle(Slot), ExpectedAngle));
+			// Start every path from the same state each step so errors don't compound
+			SimdBatch.SetVelocity(Slot, ExpectedVelocity);
+			ScalarBatch.SetVelocity(Slot, ExpectedVelocity);
+			BaselineKarts[Index].Velocity = ExpectedVelocity;
+		}
+	}
+	AddInfo(FString::Printf(TEXT("%d karts, %d steps: scalar vs baseline velocity %g angle %g, SIMD velocity %g angle %g"),
+		NumKarts, NumSteps, MaxScalarVelocityError, MaxScalarAngleError, MaxSimdVelocityError, MaxSimdAngleError));
+	TestTrue(TEXT("Scalar velocity matches the baseline integration"), MaxScalarVelocityError < 1e-4f);
+	TestTrue(TEXT("Scalar rotation matches the baseline integration"), MaxScalarAngleError < 1e-5f);
+	TestTrue(TEXT("SIMD velocity matches"), MaxSimdVelocityError < 1e-4f);
+	TestTrue(TEXT("SIMD rotation matches"), MaxSimdAngleError < 1e-5f);
+	return true;
+}
+
+// Karts whose drag response lands exactly on (and a few float steps either side of) a multiple of SubstepDragResponse,
+// where the scalar and SIMD paths would split the move differently if they worked out the substep count differently
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGoKartKinematicsSubstepBoundaryTest, "KrazyKarts.Kinematics.SubstepBoundary", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FGoKartKinematicsSubstepBoundaryTest::RunTest(const FString& Parameters)
+{
+	// No throttle or rolling resistance, so DragResponse = 2 * Drag * Speed / Mass * DeltaTime = Speed / 100, which puts
+	// 400m/s right on the boundary between 4 and 5 substeps
+	FGoKartKinematicsTuning Tuning = FGoKartKinematicsTuning::Make(1000, 10000, 10, 0, 10, 9.81f);
+	Tuning.MaxSubsteps = 8;
+	const float BoundarySpeed = 400;
+	const int32 NumSteps = 8;
+	FGoKartKinematicsBatch SimdBatch;
+	FGoKartKinematicsBatch ScalarBatch;
+	TArray<int32> Slots;
+	for (int32 Step = -NumSteps; Step <= NumSteps; ++Step)
+	{
+		float Speed = BoundarySpeed * (1 + Step * FLT_EPSILON);
+		int32 Slot = SimdBatch.AddKart();
+		verify(ScalarBatch.AddKart() == Slot);
+		for (FGoKartKinematicsBatch* Batch : { &SimdBatch, &ScalarBatch })
+		{
+			Batch->SetTuning(Slot, Tuning);
+			Batch->SetVelocity(Slot, FVector(Speed, 0, 0));
+			Batch->SetMove(Slot, FVector::ForwardVector, FVector::UpVector, 0, 0, 0.05f);
+		}
+		Slots.Add(Slot);
+	}
+	SimdBatch.IntegrateForces();
+	float MaxVelocityError = 0;
+	for (int32 Slot : Slots)
+	{
+		ScalarBatch.IntegrateForces(Slot);
+		FVector Expected = ScalarBatch.GetVelocity(Slot);
+		MaxVelocityError = FMath::Max(MaxVelocityError, (SimdBatch.GetVelocity(Slot) - Expected).Size() / Expected.Size());
+	}
+	// One substep more or less changes the result by about 2e-3
+	AddInfo(FString::Printf(TEXT("max relative velocity error %g"), MaxVelocityError));
+	TestTrue(TEXT("SIMD and scalar paths substep the same"), MaxVelocityError < 1e-5f);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,169 @@
+#include "KrazyKarts/Testing/GoKartLoadTestSubsystem.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/PlatformProcess.h"
+#include "Math/RandomStream.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "KrazyKarts/Pawns/GoKart.h"
+
+static const TCHAR* LoadTestReportHeader = TEXT("Role,Time,Karts,FrameCpuMs,MaxFrameCpuMs,SimulationMs,OutBytesPerSec,OutBytesPerKartPerSec,InBytesPerSec,")
+	TEXT("MoveRpcsSentPerSec,MoveRpcsReceivedPerSec,MovesReceivedPerSec,ServerStatesPerSec,ReplaysPerSec,ReplayedMovesPerSec,MovesTrimmed,MoveQueueOverflows,RoundTripMs");
+
+bool UGoKartLoadTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return Super::ShouldCreateSubsystem(Outer) && FParse::Param(FCommandLine::Get(), TEXT("KartLoadTest"));
+}
+
+void UGoKartLoadTestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	FParse::Value(FCommandLine::Get(), TEXT("KartLoadTestDuration="), Duration);
+	FParse::Value(FCommandLine::Get(), TEXT("KartLoadTestInterval="), ReportInterval);
+	ReportInterval = FMath::Max(ReportInterval, 1.f);
+	int32 Seed = 0;
+	FParse::Value(FCommandLine::Get(), TEXT("KartBotSeed="), Seed);
+	// Every bot drives the same kind of lap - long sweeping turns with a weave on top and the odd stop - but out of
+	// step with each other so they spread out around the track
+	FRandomStream Random(Seed);
+	SteeringFrequency = Random.FRandRange(0.3f, 0.7f);
+	SteeringPhase = Random.FRandRange(0, 2 * PI);
+	WeaveFrequency = Random.FRandRange(1.5f, 3);
+	BrakePeriod = Random.FRandRange(8, 16);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UGoKartLoadTestSubsystem::DriveBots);
+}
+
+void UGoKartLoadTestSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	if (!bFinished && ReportRows.Num() > 0)
+	{
+		WriteReport();
+	}
+	Super::Deinitialize();
+}
+
+void UGoKartLoadTestSubsystem::DriveBots(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if (World != GetWorld() || bFinished) return;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* Controller = It->Get();
+		AGoKart* Kart = Controller != nullptr && Controller->IsLocalController() ? Cast<AGoKart>(Controller->GetPawn()) : nullptr;
+		if (Kart != nullptr)
+		{
+			DriveBot(Kart);
+		}
+	}
+}
+
+void UGoKartLoadTestSubsystem::DriveBot(AGoKart* Kart) const
+{
+	float Time = ElapsedTime;
+	float Steering = 0.6f * FMath::Sin(Time * SteeringFrequency * 2 * PI + SteeringPhase) + 0.3f * FMath::Sin(Time * WeaveFrequency * 2 * PI);
+	// Full throttle for most of each period, then brake hard into a stop
+	float Throttle = FMath::Fmod(Time, BrakePeriod) < BrakePeriod - 2 ? 1.f : -1.f;
+	Kart->MoveForward(Throttle);
+	Kart->MoveRight(FMath::Clamp(Steering, -1.f, 1.f));
+}
+
+void UGoKartLoadTestSubsystem::Tick(float DeltaTime)
+{
+	if (bFinished) return;
+	ElapsedTime += DeltaTime;
+	TimeSinceReport += DeltaTime;
+	// The engine's last frame minus however long it slept at the start of it to hold the tick rate
+	float CpuTime = FMath::Max(static_cast<float>(FApp::GetDeltaTime() - FApp::GetIdleTime()), 0.f);
+	FrameCpuTime += CpuTime;
+	MaxFrameCpuTime = FMath::Max(MaxFrameCpuTime, CpuTime);
+	++ReportFrames;
+	if (TimeSinceReport >= ReportInterval)
+	{
+		Report(TimeSinceReport);
+		TimeSinceReport = 0;
+		FrameCpuTime = 0;
+		MaxFrameCpuTime = 0;
+		ReportFrames = 0;
+	}
+	if (Duration > 0 && ElapsedTime >= Duration)
+	{
+		bFinished = true;
+		WriteReport();
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+// Log and record the rates of everything counted since our last report
+void UGoKartLoadTestSubsystem::Report(float Interval)
+{
+	UGoKartSimulationSubsystem* Simulation = GetWorld()->GetSubsystem<UGoKartSimulationSubsystem>();
+	if (Simulation == nullptr) return;
+	const FGoKartNetCounters& Counters = Simulation->GetNetCounters();
+	bool bServer = GetWorld()->GetNetMode() != NM_Client;
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	int32 OutBytesPerSecond = NetDriver != nullptr ? NetDriver->OutBytesPerSecond : 0;
+	int32 InBytesPerSecond = NetDriver != nullptr ? NetDriver->InBytesPerSecond : 0;
+	int32 NumKarts = Simulation->GetNumKarts();
+
+	int64 Frames = FMath::Max<int64>(Counters.Frames - LastCounters.Frames, 1);
+	float FrameCpuMs = FrameCpuTime * 1000 / FMath::Max(ReportFrames, 1);
+	float SimulationMs = FPlatformTime::ToMilliseconds64(Counters.SimulationCycles - LastCounters.SimulationCycles) / Frames;
+	float OutBytesPerKart = bServer ? static_cast<float>(OutBytesPerSecond) / FMath::Max(NumKarts, 1) : 0;
+	auto PerSecond = [Interval](int64 Now, int64 Last)
+	{
+		return (Now - Last) / Interval;
+	};
+	float RoundTripMs = bServer ? 0 : static_cast<float>(Simulation->GetClock().GetRoundTripTicks()) * 1000 / FGoKartNetClock::TicksPerSecond;
+
+	FString Row = FString::Printf(TEXT("%s,%.1f,%d,%.2f,%.2f,%.3f,%d,%.1f,%d,%.1f,%.1f,%.1f,%.1f,%.2f,%.1f,%lld,%lld,%.1f"),
+		bServer ? TEXT("Server") : TEXT("Client"), ElapsedTime, NumKarts, FrameCpuMs, MaxFrameCpuTime * 1000, SimulationMs,
+		OutBytesPerSecond, OutBytesPerKart, InBytesPerSecond,
+		PerSecond(Counters.MoveRpcsSent, LastCounters.MoveRpcsSent),
+		PerSecond(Counters.MoveRpcsReceived, LastCounters.MoveRpcsReceived),
+		PerSecond(Counters.MovesReceived, LastCounters.MovesReceived),
+		PerSecond(Counters.ServerStatesPublished, LastCounters.ServerStatesPublished),
+		PerSecond(Counters.Replays, LastCounters.Replays),
+		PerSecond(Counters.ReplayedMoves, LastCounters.ReplayedMoves),
+		Counters.MovesTrimmed, Counters.MoveQueueOverflows, RoundTripMs);
+	UE_LOG(LogTemp, Display, TEXT("KartLoadTest: %s"), *Row);
+	ReportRows.Add(MoveTemp(Row));
+	LastCounters = Counters;
+}
+
+void UGoKartLoadTestSubsystem::WriteReport() const
+{
+	bool bServer = GetWorld() != nullptr && GetWorld()->GetNetMode() != NM_Client;
+	FString FileName = FString::Printf(TEXT("%s-%u.csv"), bServer ? TEXT("Server") : TEXT("Client"), FPlatformProcess::GetCurrentProcessId());
+	FString FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("LoadTest"), FileName);
+	TArray<FString> Lines;
+	Lines.Reserve(ReportRows.Num() + 1);
+	Lines.Add(LoadTestReportHeader);
+	Lines.Append(ReportRows);
+	if (FFileHelper::SaveStringArrayToFile(Lines, *FilePath))
+	{
+		UE_LOG(LogTemp, Display, TEXT("KartLoadTest: wrote %d rows to %s"), ReportRows.Num(), *FilePath);
+	}
+}
+
+bool UGoKartLoadTestSubsystem::IsTickable() const
+{
+	return GetWorld() != nullptr && GetWorld()->IsGameWorld();
+}
+
+ETickableTickType UGoKartLoadTestSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UGoKartLoadTestSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UGoKartLoadTestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGoKartLoadTestSubsystem, STATGROUP_Tickables);
+}
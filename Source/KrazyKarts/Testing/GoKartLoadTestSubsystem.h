@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "KrazyKarts/Simulation/GoKartSimulationSubsystem.h"
+#include "GoKartLoadTestSubsystem.generated.h"
+
+class AGoKart;
+
+// Only exists when the game is started with -KartLoadTest (see Scripts/RunKartLoadTest.sh). Drives our locally
+// controlled karts with scripted input and periodically logs the netcode rates of this process, writing them all to
+// Saved/LoadTest/<Role>-<ProcessId>.csv when the run ends.
+//
+// Command line options:
+//   -KartLoadTestDuration=<seconds>  Exit after this long, 0 runs until closed (default 0)
+//   -KartLoadTestInterval=<seconds>  How often to log and record a row (default 5)
+//   -KartBotSeed=<int>               Varies the driving script between clients (default 0)
+UCLASS()
+class KRAZYKARTS_API UGoKartLoadTestSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+private:
+	float Duration = 0;
+	float ReportInterval = 5;
+	// The driving script's frequencies and phases, picked from the bot seed
+	float SteeringFrequency = 0.5f;
+	float SteeringPhase = 0;
+	float WeaveFrequency = 2;
+	float BrakePeriod = 12;
+
+	float ElapsedTime = 0;
+	float TimeSinceReport = 0;
+	// Game thread time spent working rather than waiting for the next frame (seconds) - a dedicated server's frames
+	// are padded out to its tick rate, so their length alone says nothing about load
+	double FrameCpuTime = 0;
+	float MaxFrameCpuTime = 0;
+	int32 ReportFrames = 0;
+	FGoKartNetCounters LastCounters;
+	TArray<FString> ReportRows;
+	bool bFinished = false;
+	FDelegateHandle PostActorTickHandle;
+
+	// Overwrite every locally controlled kart's input with this frame of the driving script. Runs once all actors have
+	// ticked, so after the PlayerControllers have read their (idle) input and before the simulation subsystem turns it
+	// into moves.
+	void DriveBots(UWorld* World, ELevelTick TickType, float DeltaTime);
+	void DriveBot(AGoKart* Kart) const;
+	void Report(float Interval);
+	void WriteReport() const;
+};
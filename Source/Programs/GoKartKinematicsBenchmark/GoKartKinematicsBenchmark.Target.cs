@@ -0,0 +1,22 @@
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+// A console program with no engine, UObjects or game module - just Core and the GoKartKinematics module
+public class GoKartKinematicsBenchmarkTarget : TargetRules
+{
+	public GoKartKinematicsBenchmarkTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Program;
+		LinkType = TargetLinkType.Monolithic;
+		DefaultBuildSettings = BuildSettingsVersion.V2;
+		LaunchModuleName = "GoKartKinematicsBenchmark";
+
+		bBuildDeveloperTools = false;
+		bBuildWithEditorOnlyData = true;
+		bCompileAgainstEngine = false;
+		bCompileAgainstCoreUObject = false;
+		bCompileAgainstApplicationCore = false;
+		bCompileICU = false;
+		bIsBuildingConsoleApplication = true;
+	}
+}
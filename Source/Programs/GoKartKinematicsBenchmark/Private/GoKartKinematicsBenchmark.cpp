@@ -0,0 +1,166 @@
+#include "RequiredProgramMainCPPInclude.h"
+#include "Math/RandomStream.h"
+#include "GoKartKinematicsBatch.h"
+
+// Times the kart kinematics on their own, in a program built from nothing but Core and the GoKartKinematics module (see
+// Scripts/RunKartKinematicsBenchmark.sh), and logs moves per second for one kart stepped through FGoKartKinematics and
+// for a batch of karts through the scalar and SIMD paths of FGoKartKinematicsBatch. Returns non-zero if the two batch
+// paths disagree.
+//
+// Command line options:
+//   -Karts=<int>     Karts in the batched runs (default 1024)
+//   -Moves=<int>     Moves each kart simulates (default 1000)
+//   -Seed=<int>      Seed for the random tuning and input (default 0)
+//   -Substeps=<int>  Most substeps per move, 1 for plain Euler (default 1)
+
+DEFINE_LOG_CATEGORY_STATIC(LogGoKartKinematicsBenchmark, Log, All);
+
+IMPLEMENT_APPLICATION(GoKartKinematicsBenchmark, "GoKartKinematicsBenchmark");
+
+// The same kind of input a driven kart sees - mostly flat ground, any heading, 5-50ms moves
+static FGoKartKinematicsInput MakeRandomInput(FRandomStream& Random)
+{
+	FGoKartKinematicsInput Input;
+	Input.Up = FVector(Random.FRandRange(-0.1f, 0.1f), Random.FRandRange(-0.1f, 0.1f), 1).GetSafeNormal();
+	Input.Forward = FVector::VectorPlaneProject(Random.GetUnitVector(), Input.Up).GetSafeNormal();
+	Input.Throttle = Random.FRandRange(-1, 1);
+	Input.SteeringThrow = Random.FRandRange(-1, 1);
+	Input.DeltaTime = Random.FRandRange(0.005f, 0.05f);
+	return Input;
+}
+
+static FGoKartKinematicsTuning MakeRandomTuning(FRandomStream& Random, int32 MaxSubsteps)
+{
+	FGoKartKinematicsTuning Tuning = FGoKartKinematicsTuning::Make(Random.FRandRange(500, 2000), Random.FRandRange(5000, 20000), Random.FRandRange(4, 32), Random.FRandRange(0.005f, 0.03f), Random.FRandRange(5, 20), 9.81f);
+	Tuning.MaxSubsteps = MaxSubsteps;
+	return Tuning;
+}
+
+static void LogResult(const TCHAR* Name, int64 NumMoves, double Seconds, const FVector& Checksum)
+{
+	Seconds = FMath::Max(Seconds, 1e-9);
+	// The checksum is only logged so the compiler can't throw the work away
+	UE_LOG(LogGoKartKinematicsBenchmark, Display, TEXT("KartKinematicsBenchmark: %-8s %lld moves in %.3fms, %.0f moves/s, %.1fns/move (checksum %s)"),
+		Name, NumMoves, Seconds * 1000, NumMoves / Seconds, Seconds * 1e9 / NumMoves, *Checksum.ToString());
+}
+
+static int32 RunBenchmark(const TCHAR* Params)
+{
+	int32 NumKarts = 1024;
+	int32 NumMoves = 1000;
+	int32 Seed = 0;
+	int32 MaxSubsteps = 1;
+	FParse::Value(Params, TEXT("Karts="), NumKarts);
+	FParse::Value(Params, TEXT("Moves="), NumMoves);
+	FParse::Value(Params, TEXT("Seed="), Seed);
+	FParse::Value(Params, TEXT("Substeps="), MaxSubsteps);
+	NumKarts = FMath::Max(NumKarts, 1);
+	NumMoves = FMath::Max(NumMoves, 1);
+	MaxSubsteps = FMath::Max(MaxSubsteps, 1);
+
+	// Make everything up front so only the kinematics are timed
+	FRandomStream Random(Seed);
+	TArray<FGoKartKinematicsInput> Inputs;
+	Inputs.Reserve(NumMoves);
+	for (int32 Move = 0; Move < NumMoves; ++Move)
+	{
+		Inputs.Add(MakeRandomInput(Random));
+	}
+	TArray<FGoKartKinematicsTuning> Tunings;
+	TArray<FVector> StartVelocities;
+	for (int32 Kart = 0; Kart < NumKarts; ++Kart)
+	{
+		Tunings.Add(MakeRandomTuning(Random, MaxSubsteps));
+		StartVelocities.Add(Random.GetUnitVector() * Random.FRandRange(0, 30));
+	}
+	FGoKartKinematicsBatch ScalarBatch;
+	FGoKartKinematicsBatch SimdBatch;
+	for (int32 Kart = 0; Kart < NumKarts; ++Kart)
+	{
+		verify(ScalarBatch.AddKart() == Kart);
+		verify(SimdBatch.AddKart() == Kart);
+		ScalarBatch.SetTuning(Kart, Tunings[Kart]);
+		SimdBatch.SetTuning(Kart, Tunings[Kart]);
+		ScalarBatch.SetVelocity(Kart, StartVelocities[Kart]);
+		SimdBatch.SetVelocity(Kart, StartVelocities[Kart]);
+	}
+	UE_LOG(LogGoKartKinematicsBenchmark, Display, TEXT("KartKinematicsBenchmark: %d karts, %d moves each, up to %d substeps, seed %d"), NumKarts, NumMoves, MaxSubsteps, Seed);
+
+	// One kart through the whole move, as an offline tool would run it. Every kart's moves in turn, so the move count
+	// matches the batched runs.
+	{
+		FVector Checksum = FVector::ZeroVector;
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Kart = 0; Kart < NumKarts; ++Kart)
+		{
+			FVector Velocity = StartVelocities[Kart];
+			for (const FGoKartKinematicsInput& Input : Inputs)
+			{
+				FGoKartKinematicsStep Step = FGoKartKinematics::Step(Tunings[Kart], Velocity, Input);
+				Velocity = Step.Velocity;
+				Checksum += Step.Translation;
+			}
+			Checksum += Velocity;
+		}
+		LogResult(TEXT("Single"), static_cast<int64>(NumKarts) * NumMoves, FPlatformTime::Seconds() - StartTime, Checksum);
+	}
+
+	// Every kart a move at a time, the way the Simulation Subsystem runs them
+	for (bool bSimd : { false, true })
+	{
+		FGoKartKinematicsBatch& Batch = bSimd ? SimdBatch : ScalarBatch;
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Move = 0; Move < NumMoves; ++Move)
+		{
+			for (int32 Kart = 0; Kart < NumKarts; ++Kart)
+			{
+				// Offset each kart into the input so they don't all drive the same way
+				const FGoKartKinematicsInput& Input = Inputs[(Move + Kart) % NumMoves];
+				Batch.SetMove(Kart, Input.Forward, Input.Up, Input.Throttle, Input.SteeringThrow, Input.DeltaTime);
+			}
+			if (bSimd)
+			{
+				Batch.IntegrateForces();
+				Batch.IntegrateRotation();
+			}
+			else
+			{
+				for (int32 Kart = 0; Kart < NumKarts; ++Kart)
+				{
+					Batch.IntegrateForces(Kart);
+					Batch.IntegrateRotation(Kart);
+				}
+			}
+		}
+		double Elapsed = FPlatformTime::Seconds() - StartTime;
+		FVector Checksum = FVector::ZeroVector;
+		for (int32 Kart = 0; Kart < NumKarts; ++Kart)
+		{
+			Checksum += Batch.GetVelocity(Kart);
+		}
+		LogResult(bSimd ? TEXT("SIMD") : TEXT("Scalar"), static_cast<int64>(NumKarts) * NumMoves, Elapsed, Checksum);
+	}
+
+	// Both batches ran the same moves, so they should have ended up (almost) together. Errors compound over a long run,
+	// so this is a much looser check than the KrazyKarts.Kinematics.BatchEquivalence automation test.
+	float MaxVelocityError = 0;
+	for (int32 Kart = 0; Kart < NumKarts; ++Kart)
+	{
+		FVector Difference = SimdBatch.GetVelocity(Kart) - ScalarBatch.GetVelocity(Kart);
+		MaxVelocityError = FMath::Max(MaxVelocityError, Difference.Size() / FMath::Max(1.f, ScalarBatch.GetVelocity(Kart).Size()));
+	}
+	bool bPassed = MaxVelocityError < 1e-2f;
+	UE_LOG(LogGoKartKinematicsBenchmark, Display, TEXT("KartKinematicsBenchmark: max relative velocity difference between scalar and SIMD %g - %s"),
+		MaxVelocityError, bPassed ? TEXT("PASSED") : TEXT("FAILED"));
+	return bPassed ? 0 : 1;
+}
+
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV()
+{
+	GEngineLoop.PreInit(ArgC, ArgV);
+	int32 Result = RunBenchmark(FCommandLine::Get());
+	FEngineLoop::AppPreExit();
+	FModuleManager::Get().UnloadModulesAtShutdown();
+	FEngineLoop::AppExit();
+	return Result;
+}